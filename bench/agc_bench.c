@@ -0,0 +1,273 @@
+/*
+ * agc_bench.c - Performance regression suite.
+ *
+ *   agc_bench [--json] [--reps N] [--quick] [filter]
+ *
+ * Each scenario runs once to warm up and then --reps times (default 5);
+ * the table (or JSON with --json) reports the median and best ns/op and
+ * the median ops/sec. An "op" is one emulated instruction, except for
+ * memory_read (one agc_memory_read call) and rom_load (one image load).
+ * A filter runs only the scenarios whose name contains it.
+ *
+ * tc_loop_paced runs the tc_loop_exec loop through agc_cpu_run_paced()
+ * at a rate the host cannot reach, so it never sleeps; the difference
+ * from tc_loop_exec is the cost of the pacer's slicing and clock reads.
+ *
+ * A scenario whose run returns 0 has failed (e.g. agc_main could not be
+ * started); its name goes to stderr and agc_bench exits with status 1.
+ *
+ * repl_run and repl_qrun feed commands to the agc_main executable with
+ * its output discarded, so they include the REPL's parsing, disassembly
+ * and printing; process start-up is amortized over the run.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "agc_cpu.h"
+#include "agc_memory.h"
+#include "agc_rope.h"
+#include "agc_timing.h"
+
+#define MAX_REPS 64
+
+typedef struct {
+    const char *name;
+    const char *op;             // What one op is
+    uint64_t ops;               // Ops per repetition (before --quick)
+    // Runs ops operations; returns a value derived from the work so it
+    // cannot be optimized away
+    uint64_t (*run)(uint64_t ops);
+} scenario_t;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static agc_cpu_t cpu;
+
+// TC 0 forever; idle skip off so every pass is really executed
+static void setup_tc_loop(void) {
+    agc_cpu_reset(&cpu);
+    cpu.idle_skip = false;
+    agc_memory_write(&cpu, 0, 000000);  // TC 0
+}
+
+static uint64_t run_tc_step(uint64_t ops) {
+    setup_tc_loop();
+    for (uint64_t i = 0; i < ops; i++)
+        agc_cpu_step(&cpu);
+    return cpu.cycle_count;
+}
+
+static uint64_t run_tc_exec(uint64_t ops) {
+    setup_tc_loop();
+    return agc_cpu_exec(&cpu, ops) + cpu.cycle_count;
+}
+
+static uint64_t run_tc_paced(uint64_t ops) {
+    setup_tc_loop();
+    agc_pacer_t pacer;
+    uint64_t executed;
+    agc_pacer_start(&pacer, &cpu, 1e6);
+    agc_cpu_run_paced(&cpu, &pacer, ops, 0, &executed);
+    return executed + cpu.cycle_count;
+}
+
+// CA/TS/XCH loop, written into both erasable banks with different data
+static void setup_traffic(void) {
+    agc_cpu_reset(&cpu);
+    for (int eb = 1; eb >= 0; eb--) {
+        cpu.EB = (uint8_t)eb;
+        agc_memory_write(&cpu, 0, 030100);  // CA 0100
+        agc_memory_write(&cpu, 1, 010101);  // XCH 0101
+        agc_memory_write(&cpu, 2, 020102);  // TS 0102
+        agc_memory_write(&cpu, 3, 010100);  // XCH 0100
+        agc_memory_write(&cpu, 4, 000000);  // TC 0
+        agc_memory_write(&cpu, 0100, (agc_word_t)(01111 * (eb + 1)));
+        agc_memory_write(&cpu, 0101, (agc_word_t)(02222 * (eb + 1)));
+    }
+}
+
+// Host alternates EB every 1000 instructions
+static uint64_t run_traffic(uint64_t ops) {
+    setup_traffic();
+    uint64_t done = 0;
+    while (done < ops) {
+        uint64_t chunk = ops - done < 1000 ? ops - done : 1000;
+        done += agc_cpu_exec(&cpu, chunk);
+        cpu.EB ^= 1;
+    }
+    return done + cpu.A;
+}
+
+// EB and FB change before every instruction, forcing a rebank each step
+static uint64_t run_bank_switch(uint64_t ops) {
+    setup_traffic();
+    for (uint64_t i = 0; i < ops; i++) {
+        cpu.EB ^= 1;
+        cpu.FB = (uint8_t)((cpu.FB + 1) % (AGC_ROM_SIZE / AGC_FIXED_BANK_SIZE));
+        agc_cpu_step(&cpu);
+    }
+    return cpu.cycle_count + cpu.A;
+}
+
+// Contents of the benchmark rope, in memory and in the image file
+static agc_word_t rom_word(int i) {
+    return (agc_word_t)((i * 0x9e37u) & 077777);
+}
+
+static agc_rope_t read_rope;
+static agc_word_t read_addrs[4096];
+
+// Reads spread over erasable and fixed memory in several banks, all of
+// it holding non-zero data so the sum shows the reads were made
+static uint64_t run_memory_read(uint64_t ops) {
+    for (int i = 0; i < AGC_ROM_SIZE; i++)
+        read_rope.words[i] = rom_word(i) | 1;
+    agc_rope_decode(&read_rope);
+    agc_cpu_reset(&cpu);
+    agc_memory_attach_rope(&cpu, &read_rope);
+    for (int i = 0; i < AGC_RAM_SIZE; i++)
+        cpu.erasable[i] = (agc_word_t)(i | 1);
+
+    uint32_t x = 12345, sum = 0;
+    for (int i = 0; i < 4096; i++) {
+        x = x * 1103515245u + 12345u;
+        read_addrs[i] = (agc_word_t)((x >> 8) & 07777);
+    }
+    for (uint64_t i = 0; i < ops; i++) {
+        if ((i & 4095) == 0) cpu.FB = (uint8_t)((i >> 12) % 9);
+        sum += agc_memory_read(&cpu, read_addrs[i & 4095]);
+    }
+    return sum;
+}
+
+static char rom_path[64];
+
+// Full-size big-endian image in a temporary file
+static bool write_rom_image(void) {
+    snprintf(rom_path, sizeof(rom_path), "/tmp/agc_bench_%ld.bin", (long)getpid());
+    FILE *f = fopen(rom_path, "wb");
+    if (!f) return false;
+    for (int i = 0; i < AGC_ROM_SIZE; i++) {
+        agc_word_t w = rom_word(i);
+        fputc(w >> 8, f);
+        fputc(w & 0xff, f);
+    }
+    return fclose(f) == 0;
+}
+
+static uint64_t run_rom_load(uint64_t ops) {
+    uint64_t ok = 0;
+    for (uint64_t i = 0; i < ops; i++)
+        ok += agc_load_rom(rom_path);
+    return ok;
+}
+
+// Path of agc_main, baked in by CMake
+#ifndef AGC_MAIN_PATH
+#define AGC_MAIN_PATH "./agc_main"
+#endif
+
+static uint64_t run_repl(const char *cmd, uint64_t ops) {
+    FILE *p = popen(AGC_MAIN_PATH " > /dev/null", "w");
+    if (!p) return 0;
+    fprintf(p, "poke 0 010100\npoke 1 000000\npoke 0100 1\n%s %llu\nquit\n", cmd, (unsigned long long)ops);
+    return pclose(p) == 0 ? ops : 0;
+}
+
+static uint64_t run_repl_run(uint64_t ops) { return run_repl("run", ops); }
+static uint64_t run_repl_qrun(uint64_t ops) { return run_repl("qrun", ops); }
+
+static const scenario_t scenarios[] = {
+    { "tc_loop_step",  "instr",  20000000, run_tc_step },
+    { "tc_loop_exec",  "instr",  50000000, run_tc_exec },
+    { "tc_loop_paced", "instr",  50000000, run_tc_paced },
+    { "mem_traffic",   "instr",  50000000, run_traffic },
+    { "bank_switch",   "instr",  10000000, run_bank_switch },
+    { "memory_read",   "read",   50000000, run_memory_read },
+    { "rom_load",      "load",        200, run_rom_load },
+    { "repl_run",      "instr",    200000, run_repl_run },
+    { "repl_qrun",     "instr",  20000000, run_repl_qrun },
+};
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    bool json = false, quick = false;
+    int reps = 5;
+    const char *filter = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) json = true;
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (argv[i][0] != '-') filter = argv[i];
+        else {
+            fprintf(stderr, "usage: agc_bench [--json] [--reps N] [--quick] [filter]\n");
+            return 2;
+        }
+    }
+    if (reps < 1) reps = 1;
+    if (reps > MAX_REPS) reps = MAX_REPS;
+
+    if (!write_rom_image()) {
+        fprintf(stderr, "cannot write temporary ROM image\n");
+        return 1;
+    }
+
+    if (json)
+        printf("{\n  \"suite\": \"agc_bench\",\n  \"version\": 1,\n  \"reps\": %d,\n  \"results\": [", reps);
+    else
+        printf("%-14s %12s %12s %14s  %s\n", "scenario", "ns/op", "best ns/op", "ops/sec", "op");
+
+    bool first = true, failed = false;
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        const scenario_t *sc = &scenarios[s];
+        if (filter && !strstr(sc->name, filter)) continue;
+
+        uint64_t ops = quick ? (sc->ops / 20 ? sc->ops / 20 : 1) : sc->ops;
+        volatile uint64_t sink = sc->run(ops / 10 ? ops / 10 : 1);   // Warm-up
+
+        double ns[MAX_REPS];
+        bool sc_failed = false;
+        for (int r = 0; r < reps; r++) {
+            double t0 = now_sec();
+            uint64_t check = sc->run(ops);
+            ns[r] = (now_sec() - t0) * 1e9 / (double)ops;
+            sink += check;
+            if (check == 0 && !sc_failed) {
+                fprintf(stderr, "agc_bench: scenario %s failed\n", sc->name);
+                sc_failed = failed = true;
+            }
+        }
+        (void)sink;
+        qsort(ns, (size_t)reps, sizeof(ns[0]), cmp_double);
+        double median = ns[reps / 2], best = ns[0];
+
+        if (json) {
+            printf("%s\n    { \"name\": \"%s\", \"op\": \"%s\", \"ops\": %llu, "
+                   "\"ns_per_op\": %.3f, \"best_ns_per_op\": %.3f, \"ops_per_sec\": %.0f }",
+                   first ? "" : ",", sc->name, sc->op, (unsigned long long)ops,
+                   median, best, 1e9 / median);
+        } else {
+            printf("%-14s %12.3f %12.3f %14.0f  %s\n", sc->name, median, best, 1e9 / median, sc->op);
+        }
+        fflush(stdout);
+        first = false;
+    }
+
+    if (json)
+        printf("\n  ]\n}\n");
+    remove(rom_path);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * bench_memory.c - Microbenchmark for banked memory translation.
+ *
+ * Compares the original per-access translation (modulo, multiply and
+ * clamp on every read) with the cached bank base pointers used by
+ * agc_memory_read() and agc_memory_read_banked().
+ */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <time.h>
+#include "agc_cpu.h"
+#include "agc_memory.h"
+
+#define ACCESSES  (1u << 26)
+#define ADDRS     4096
+#define ADDR_MASK 07777   // Touch both erasable and fixed addresses
+
+typedef agc_word_t (*read_fn)(agc_cpu_t *cpu, agc_word_t addr);
+
+/*
+ * The translation agc_memory_read() performed before bank caching.
+ */
+static agc_word_t legacy_read(agc_cpu_t *cpu, agc_word_t addr) {
+    addr = addr & 077777;
+
+    if (addr < AGC_ERASE_BANK_SIZE) {
+        uint8_t eb = cpu->EB % (AGC_RAM_SIZE / AGC_ERASE_BANK_SIZE);
+        int phys = eb * AGC_ERASE_BANK_SIZE + addr;
+        return cpu->erasable[phys];
+    } else {
+        uint8_t fb = cpu->FB % (AGC_ROM_SIZE / AGC_FIXED_BANK_SIZE);
+        int phys = fb * AGC_FIXED_BANK_SIZE + (addr - AGC_ERASE_BANK_SIZE);
+        if (phys < 0) phys = 0;
+        if (phys >= AGC_ROM_SIZE) phys = AGC_ROM_SIZE - 1;
+        return cpu->rope->words[phys];
+    }
+}
+
+static agc_word_t banked_read(agc_cpu_t *cpu, agc_word_t addr) {
+    return agc_memory_read_banked(cpu, addr);
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static agc_word_t addrs[ADDRS];
+
+static double run(const char *name, read_fn read, agc_cpu_t *cpu) {
+    volatile read_fn fn = read;   // Keep every access an opaque call
+    read_fn call = fn;
+    uint32_t sum = 0;
+
+    double start = now_sec();
+    for (uint32_t r = 0; r < ACCESSES / ADDRS; r++)
+        for (uint32_t i = 0; i < ADDRS; i++)
+            sum += call(cpu, addrs[i]);
+    double elapsed = now_sec() - start;
+
+    double ns = elapsed * 1e9 / ACCESSES;
+    printf("%-10s %8.3f ns/access  (checksum %08x)\n", name, ns, sum);
+    return ns;
+}
+
+/*
+ * Same loop with the translation inlined, so the call overhead does
+ * not hide the cost of the translation itself.
+ */
+#define RUN_INLINE(result, name, expr)                                  \
+    do {                                                                \
+        uint32_t sum = 0;                                               \
+        double start = now_sec();                                       \
+        for (uint32_t r = 0; r < ACCESSES / ADDRS; r++)                 \
+            for (uint32_t i = 0; i < ADDRS; i++) {                      \
+                agc_word_t addr = addrs[i];                             \
+                sum += (expr);                                          \
+            }                                                           \
+        (result) = (now_sec() - start) * 1e9 / ACCESSES;                \
+        printf("%-10s %8.3f ns/access  (checksum %08x)\n",              \
+               name, (result), sum);                                    \
+    } while (0)
+
+int main(void) {
+    static agc_cpu_t cpu;
+    agc_cpu_reset(&cpu);
+    cpu.EB = 1;
+    cpu.FB = 3;
+
+    for (uint16_t a = 0; a < AGC_ERASE_BANK_SIZE; a++)
+        agc_memory_write(&cpu, a, a);
+    agc_memory_sync_banks(&cpu);
+
+    uint32_t seed = 1;
+    for (int i = 0; i < ADDRS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        addrs[i] = (agc_word_t)((seed >> 16) & ADDR_MASK);
+    }
+
+    // Warm up caches and branch predictors
+    run("warmup", legacy_read, &cpu);
+
+    double legacy = run("legacy", legacy_read, &cpu);
+    double cached = run("read", agc_memory_read, &cpu);
+    double banked = run("banked", banked_read, &cpu);
+
+    double legacy_inl, banked_inl;
+    RUN_INLINE(legacy_inl, "legacy-inl", legacy_read(&cpu, addr));
+    RUN_INLINE(banked_inl, "banked-inl", agc_memory_read_banked(&cpu, addr));
+
+    printf("speedup: read %.2fx, banked %.2fx, inlined %.2fx\n",
+           legacy / cached, legacy / banked, legacy_inl / banked_inl);
+    return 0;
+}
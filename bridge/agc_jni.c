@@ -1 +1,100 @@
-/* agc_jni.c - JNI bridge placeholder */
+/* agc_jni.c - JNI bridge */
+#include "agc_jni.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "agc_cpu.h"
+#include "agc_memory.h"
+#include "agc_rope.h"
+
+typedef struct {
+    agc_cpu_t cpu;
+    const agc_rope_t *rope;     // Held from the registry, NULL for the default rope
+    uint64_t executed;          // Instructions run by the last run()
+} agc_jni_instance_t;
+
+static agc_jni_instance_t *instance(jlong handle) {
+    return (agc_jni_instance_t *)(intptr_t)handle;
+}
+
+JNIEXPORT jlong JNICALL Java_agc_Agc_create(JNIEnv *env, jclass cls) {
+    (void)env; (void)cls;
+    agc_jni_instance_t *inst = malloc(sizeof(*inst));
+    if (!inst) return 0;
+    agc_cpu_reset(&inst->cpu);
+    inst->rope = NULL;
+    inst->executed = 0;
+    return (jlong)(intptr_t)inst;
+}
+
+JNIEXPORT void JNICALL Java_agc_Agc_destroy(JNIEnv *env, jclass cls, jlong handle) {
+    (void)env; (void)cls;
+    agc_jni_instance_t *inst = instance(handle);
+    if (!inst) return;
+    agc_rope_release(inst->rope);
+    free(inst);
+}
+
+// Reset keeps the rope: the buffers stay valid and point at the same arrays
+JNIEXPORT void JNICALL Java_agc_Agc_reset(JNIEnv *env, jclass cls, jlong handle) {
+    (void)env; (void)cls;
+    agc_jni_instance_t *inst = instance(handle);
+    agc_cpu_reset(&inst->cpu);
+    agc_memory_attach_rope(&inst->cpu, inst->rope);
+    inst->executed = 0;
+}
+
+JNIEXPORT jboolean JNICALL Java_agc_Agc_loadRope(JNIEnv *env, jclass cls, jlong handle, jstring path) {
+    (void)cls;
+    agc_jni_instance_t *inst = instance(handle);
+    const char *p = (*env)->GetStringUTFChars(env, path, NULL);
+    if (!p) return JNI_FALSE;
+    const agc_rope_t *rope = agc_rope_acquire(p, NULL);
+    (*env)->ReleaseStringUTFChars(env, path, p);
+    if (!rope) return JNI_FALSE;
+
+    agc_memory_attach_rope(&inst->cpu, rope);
+    agc_rope_release(inst->rope);
+    inst->rope = rope;
+    return JNI_TRUE;
+}
+
+JNIEXPORT jobject JNICALL Java_agc_Agc_erasable(JNIEnv *env, jclass cls, jlong handle) {
+    (void)cls;
+    agc_cpu_t *cpu = &instance(handle)->cpu;
+    return (*env)->NewDirectByteBuffer(env, cpu->erasable, (jlong)AGC_RAM_BYTES);
+}
+
+JNIEXPORT jobject JNICALL Java_agc_Agc_registers(JNIEnv *env, jclass cls, jlong handle) {
+    (void)cls;
+    agc_cpu_t *cpu = &instance(handle)->cpu;
+    return (*env)->NewDirectByteBuffer(env, &cpu->A, AGC_JNI_REG_SIZE);
+}
+
+JNIEXPORT jobject JNICALL Java_agc_Agc_channels(JNIEnv *env, jclass cls, jlong handle) {
+    (void)cls;
+    agc_cpu_t *cpu = &instance(handle)->cpu;
+    return (*env)->NewDirectByteBuffer(env, cpu->IN, (jlong)(sizeof(cpu->IN) + sizeof(cpu->OUT)));
+}
+
+/*
+ * One crossing for the whole batch. Java may have changed EB/FB through
+ * the register buffer; the core refreshes its bank cache before fetching.
+ */
+JNIEXPORT jint JNICALL Java_agc_Agc_run(JNIEnv *env, jclass cls, jlong handle, jlong n, jint stopMask) {
+    (void)env; (void)cls;
+    agc_jni_instance_t *inst = instance(handle);
+    inst->executed = 0;
+    if (n <= 0) return AGC_STOP_COUNT;
+    return (jint)agc_cpu_run(&inst->cpu, (uint64_t)n, (uint32_t)stopMask, &inst->executed);
+}
+
+JNIEXPORT jlong JNICALL Java_agc_Agc_executed(JNIEnv *env, jclass cls, jlong handle) {
+    (void)env; (void)cls;
+    return (jlong)instance(handle)->executed;
+}
+
+JNIEXPORT jlong JNICALL Java_agc_Agc_cycles(JNIEnv *env, jclass cls, jlong handle) {
+    (void)env; (void)cls;
+    return (jlong)instance(handle)->cpu.cycle_count;
+}
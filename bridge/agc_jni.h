@@ -1 +1,43 @@
-/* agc_jni.h - JNI bridge header placeholder */
+/* agc_jni.h - JNI bridge for the Java side (class agc.Agc) */
+#ifndef AGC_JNI_H
+#define AGC_JNI_H
+
+#include <jni.h>
+
+/*
+ * One native instance per agc.Agc object, addressed by an opaque handle.
+ *
+ * State is shared, not copied: erasable(), registers() and channels()
+ * return direct ByteBuffers over the instance's own arrays, so Java reads
+ * and writes emulated memory with plain buffer accesses and no JNI call.
+ * Set the buffers to ByteOrder.nativeOrder(); every word is a 16-bit
+ * short holding a 15-bit value.
+ *
+ * registers() layout (byte offsets, AGC_JNI_* in agc_cpu.h, checked
+ * at compile time by every build of the core):
+ *   0 A   2 L   4 Q   6 Z   (shorts)
+ *   8 EB  9 FB  10 BB       (bytes)
+ * channels() layout: IN[0..15] at 0, OUT[0..15] at 32 (shorts).
+ * erasable(): 2048 shorts, bank n at short index n * 1024. Java writes
+ * to it are not seen by dirty-page tracking (agc_checkpoint.h).
+ *
+ * Execution is batched: run(n, stopMask) executes up to n instructions in
+ * one crossing and returns the agc_stop_reason_t that ended the run;
+ * executed() then reports how many ran. The buffers must not be touched
+ * by other Java threads while run() is executing.
+ */
+
+JNIEXPORT jlong JNICALL Java_agc_Agc_create(JNIEnv *env, jclass cls);
+JNIEXPORT void JNICALL Java_agc_Agc_destroy(JNIEnv *env, jclass cls, jlong handle);
+JNIEXPORT void JNICALL Java_agc_Agc_reset(JNIEnv *env, jclass cls, jlong handle);
+JNIEXPORT jboolean JNICALL Java_agc_Agc_loadRope(JNIEnv *env, jclass cls, jlong handle, jstring path);
+
+JNIEXPORT jobject JNICALL Java_agc_Agc_erasable(JNIEnv *env, jclass cls, jlong handle);
+JNIEXPORT jobject JNICALL Java_agc_Agc_registers(JNIEnv *env, jclass cls, jlong handle);
+JNIEXPORT jobject JNICALL Java_agc_Agc_channels(JNIEnv *env, jclass cls, jlong handle);
+
+JNIEXPORT jint JNICALL Java_agc_Agc_run(JNIEnv *env, jclass cls, jlong handle, jlong n, jint stopMask);
+JNIEXPORT jlong JNICALL Java_agc_Agc_executed(JNIEnv *env, jclass cls, jlong handle);
+JNIEXPORT jlong JNICALL Java_agc_Agc_cycles(JNIEnv *env, jclass cls, jlong handle);
+
+#endif // AGC_JNI_H
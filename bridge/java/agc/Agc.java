@@ -0,0 +1,93 @@
+package agc;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.ShortBuffer;
+
+/**
+ * One emulated AGC, backed by native memory (see bridge/agc_jni.h).
+ *
+ * erasable, registers and channels are views of the instance's own arrays:
+ * reading or writing them costs no JNI call. Execution is batched through
+ * run(), which returns once per stop, not once per instruction. Do not use
+ * the views from another thread while run() is executing, or at all after
+ * close().
+ */
+public final class Agc implements AutoCloseable {
+    static {
+        System.loadLibrary("agc_jni");
+    }
+
+    // Stop reasons / stop mask bits (agc_stop_reason_t)
+    public static final int STOP_COUNT      = 1 << 0;
+    public static final int STOP_BREAKPOINT = 1 << 1;
+    public static final int STOP_Z_RANGE    = 1 << 2;
+    public static final int STOP_IO_WRITE   = 1 << 3;
+    public static final int STOP_CYCLE      = 1 << 4;
+    public static final int STOP_WATCH      = 1 << 5;
+    public static final int STOP_RUPT       = 1 << 6;
+
+    // Byte offsets in registers
+    public static final int REG_A = 0, REG_L = 2, REG_Q = 4, REG_Z = 6;
+    public static final int REG_EB = 8, REG_FB = 9, REG_BB = 10;
+
+    private long handle;
+
+    /** 2048 words; bank n starts at index n * 1024. */
+    public final ShortBuffer erasable;
+    /** A, L, Q, Z as shorts, then EB, FB, BB as bytes (REG_* offsets). */
+    public final ByteBuffer registers;
+    /** IN[0..15] at index 0, OUT[0..15] at index 16. */
+    public final ShortBuffer channels;
+
+    public Agc() {
+        handle = create();
+        if (handle == 0)
+            throw new OutOfMemoryError("agc instance");
+        erasable = erasable(handle).order(ByteOrder.nativeOrder()).asShortBuffer();
+        registers = registers(handle).order(ByteOrder.nativeOrder());
+        channels = channels(handle).order(ByteOrder.nativeOrder()).asShortBuffer();
+    }
+
+    /** Run up to n instructions; returns the STOP_* reason that ended the run. */
+    public int run(long n, int stopMask) {
+        return run(handle, n, stopMask);
+    }
+
+    /** Instructions executed by the last run(). */
+    public long executed() {
+        return executed(handle);
+    }
+
+    /** Emulated time in memory cycles (11.72 us each). */
+    public long cycles() {
+        return cycles(handle);
+    }
+
+    public boolean loadRope(String path) {
+        return loadRope(handle, path);
+    }
+
+    public void reset() {
+        reset(handle);
+    }
+
+    @Override
+    public void close() {
+        if (handle != 0) {
+            destroy(handle);
+            handle = 0;
+        }
+    }
+
+    private static native long create();
+    private static native void destroy(long handle);
+    private static native void reset(long handle);
+    private static native boolean loadRope(long handle, String path);
+    private static native ByteBuffer erasable(long handle);
+    private static native ByteBuffer registers(long handle);
+    private static native ByteBuffer channels(long handle);
+    private static native int run(long handle, long n, int stopMask);
+    private static native long executed(long handle);
+    private static native long cycles(long handle);
+}
@@ -0,0 +1,100 @@
+#ifndef AGC_CAMPAIGN_H
+#define AGC_CAMPAIGN_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "agc_types.h"
+#include "agc_cpu.h"
+#include "agc_memory.h"
+#include "agc_snapshot.h"
+
+/*
+ * Monte Carlo campaigns.
+ *
+ * A campaign runs one base state many times. Each run restores the base
+ * snapshot into a worker-owned instance, applies its own perturbations
+ * (erasable words, IN channels, registers), executes with agc_cpu_run()
+ * and reports its final state as one fixed-size record.
+ *
+ * Runs are spread over a pool of threads. Each worker starts with an
+ * equal slice of the run indices and takes from its front; a worker that
+ * runs dry steals the back half of the next non-empty slice. Workers
+ * share nothing but the read-only rope and the base snapshot, so the
+ * pool scales with the number of cores.
+ */
+
+typedef enum {
+    AGC_PERTURB_ERASABLE = 1,   // erasable[bank][addr] = value
+    AGC_PERTURB_IN,             // IN[addr] = value
+    AGC_PERTURB_REG,            // register addr (agc_campaign_reg_t) = value
+} agc_perturb_kind_t;
+
+typedef enum {
+    AGC_REG_A, AGC_REG_L, AGC_REG_Q, AGC_REG_Z, AGC_REG_EB, AGC_REG_FB,
+} agc_campaign_reg_t;
+
+typedef struct {
+    uint8_t kind;               // agc_perturb_kind_t
+    uint8_t bank;               // Erasable bank for AGC_PERTURB_ERASABLE
+    uint16_t addr;
+    agc_word_t value;
+} agc_perturbation_t;
+
+// Run i applies perturbations[first[i] .. first[i + 1])
+typedef struct {
+    const agc_perturbation_t *perturbations;
+    const size_t *first;        // run_count + 1 offsets
+    size_t run_count;
+} agc_run_set_t;
+
+/*
+ * Final state of one run; 72 bytes in host byte order.
+ * erasable_hash is 64-bit FNV-1a over all of erasable memory.
+ */
+typedef struct {
+    uint32_t run;
+    uint8_t stop;               // agc_stop_reason_t
+    uint8_t EB, FB;
+    uint8_t reserved;
+    uint64_t executed;
+    uint64_t cycle_count;
+    agc_word_t A, L, Q, Z;
+    agc_word_t OUT[16];
+    uint64_t erasable_hash;
+} agc_campaign_result_t;
+
+/*
+ * Result file: this header, then one record per run in completion order
+ * (use the run field to put them back in order).
+ */
+#define AGC_CAMPAIGN_MAGIC   0x52434741u   // "AGCR"
+#define AGC_CAMPAIGN_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint64_t run_count;
+} agc_campaign_header_t;
+
+typedef struct {
+    const agc_snapshot_t *base;     // State every run starts from
+    const agc_rope_t *rope;         // NULL for the default rope
+    agc_run_set_t runs;
+
+    uint64_t max_instructions;      // Per-run budget
+    uint32_t stop_mask;             // As for agc_cpu_run()
+    unsigned threads;               // 0 = one per online CPU
+
+    FILE *out;                      // Result stream, or NULL
+    agc_campaign_result_t *results; // run_count records indexed by run, or NULL
+} agc_campaign_t;
+
+// Apply one perturbation to an instance
+void agc_perturb_apply(agc_cpu_t *cpu, const agc_perturbation_t *p);
+
+// Run the campaign to completion; false if the base snapshot is invalid,
+// threads could not be started or the result stream failed
+bool agc_campaign_run(const agc_campaign_t *campaign);
+
+#endif // AGC_CAMPAIGN_H
@@ -0,0 +1,104 @@
+#ifndef AGC_CHANNELS_H
+#define AGC_CHANNELS_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include "agc_types.h"
+#include "agc_cpu.h"
+
+struct agc_journal;
+
+/*
+ * I/O channels shared with peripherals on other threads.
+ *
+ * Each of the 16 input and 16 output channels has a single-producer,
+ * single-consumer lock-free queue. A peripheral thread (DSKY front end,
+ * IMU model, telemetry sink, ...) sends to an input channel and receives
+ * from an output channel; at most one thread may send to a given input
+ * channel and at most one may receive from a given output channel. The
+ * CPU thread is the other end of every queue, so neither side ever takes
+ * a lock or waits.
+ *
+ * Inputs: agc_cpu_run() and agc_cpu_exec() on an instance with channels
+ * attached run in slices of AGC_CHAN_BATCH instructions and drain every
+ * pending input into IN[] before each slice, in send order, so the last
+ * value sent is what the channel latches. A bitmask of channels with
+ * queued input keeps an idle drain to one atomic load. Callers that step
+ * with agc_cpu_step() drain with agc_chan_drain() when they see fit.
+ * Drained inputs arrive at cycles no other run will reproduce; give the
+ * channels a journal with agc_chan_journal() and each one is applied
+ * through agc_journal_input(), so a recording replays them exactly.
+ *
+ * Outputs: agc_io_write() also queues the value for the channel's
+ * consumer. A full queue drops the value and counts it rather than stall
+ * the emulation; OUT[] still holds the latest value.
+ */
+
+#define AGC_CHAN_QUEUE 256      // Slots per queue, a power of two
+#define AGC_CHAN_BATCH 256      // Instructions between input drains
+
+typedef struct {
+    // Consumer side: its position and the producer position it last saw
+    _Alignas(64) _Atomic uint32_t head;
+    uint32_t tail_cache;
+    // Producer side, on its own cache line
+    _Alignas(64) _Atomic uint32_t tail;
+    uint32_t head_cache;
+    agc_word_t slots[AGC_CHAN_QUEUE];
+} agc_spsc_t;
+
+typedef struct agc_channels {
+    agc_spsc_t in[16];                  // Peripheral -> CPU
+    agc_spsc_t out[16];                 // CPU -> peripheral
+    _Atomic uint32_t in_pending;        // Bit n set when in[n] may hold values
+    uint64_t in_count[16];              // Values drained, CPU thread only
+    struct agc_journal *journal;        // Logs drained values, NULL if none
+    _Atomic uint64_t out_dropped[16];   // Values lost to a full output queue
+} agc_channels_t;
+
+// Producer end: false if the queue is full
+static inline bool agc_spsc_push(agc_spsc_t *q, agc_word_t value) {
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (tail - q->head_cache == AGC_CHAN_QUEUE) {
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (tail - q->head_cache == AGC_CHAN_QUEUE)
+            return false;
+    }
+    q->slots[tail & (AGC_CHAN_QUEUE - 1)] = value;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// Consumer end: false if the queue is empty
+static inline bool agc_spsc_pop(agc_spsc_t *q, agc_word_t *value) {
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (head == q->tail_cache) {
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (head == q->tail_cache)
+            return false;
+    }
+    *value = q->slots[head & (AGC_CHAN_QUEUE - 1)];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return true;
+}
+
+// Empty every queue and clear the counters. Not thread-safe: call
+// before the peripherals start.
+void agc_chan_init(agc_channels_t *chan);
+
+// Connect chan to an instance (NULL disconnects)
+void agc_chan_attach(agc_cpu_t *cpu, agc_channels_t *chan);
+
+// Route drained inputs through journal j (NULL stops). Like the drain,
+// CPU thread only.
+void agc_chan_journal(agc_channels_t *chan, struct agc_journal *j);
+
+// Peripheral side. Send returns false if the input queue is full, receive
+// returns false if no output is waiting.
+bool agc_chan_send(agc_channels_t *chan, uint8_t channel, agc_word_t value);
+bool agc_chan_recv(agc_channels_t *chan, uint8_t channel, agc_word_t *value);
+
+// CPU side: apply every pending input to IN[]; returns how many
+size_t agc_chan_drain(agc_cpu_t *cpu);
+
+#endif // AGC_CHANNELS_H
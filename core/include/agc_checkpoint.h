@@ -0,0 +1,66 @@
+#ifndef AGC_CHECKPOINT_H
+#define AGC_CHECKPOINT_H
+
+#include <stddef.h>
+#include "agc_types.h"
+#include "agc_cpu.h"
+#include "agc_snapshot.h"
+
+/*
+ * Incremental checkpoints.
+ *
+ * Every write to erasable memory - by an instruction on any core,
+ * agc_memory_write(), a timer counter or a snapshot restore - sets the
+ * bit of its AGC_DIRTY_WORDS-word page in cpu->dirty, at the cost of one
+ * OR. A checkpoint log keeps the first checkpoint it takes as a full
+ * image, the base. Each later checkpoint stores the registers and only
+ * the pages written since the one before, then clears cpu->dirty, so a
+ * run that touches a few words between checkpoints stores a few pages
+ * per checkpoint rather than all of erasable memory.
+ *
+ * agc_ckpt_rebuild() turns any checkpoint back into a full agc_snapshot_t
+ * (restore it with agc_snapshot_restore()). Each page comes from the
+ * newest checkpoint at or before the one asked for that holds it, so a
+ * rebuild copies every page once however long the chain is.
+ *
+ * cpu->dirty has a single consumer: take checkpoints of an instance into
+ * one log. Writes through the JNI erasable buffer are not tracked.
+ */
+
+typedef struct {
+    // Registers, as in agc_snapshot_t
+    agc_word_t A, L, Q, Z;
+    uint8_t EB, FB, BB;
+    agc_word_t current_instruction;
+    uint64_t cycle_count;
+    agc_word_t IN[16];
+    agc_word_t OUT[16];
+
+    uint64_t pages;             // Erasable pages stored (all of them in the base)
+    size_t data;                // Index of the first stored word in the log's data
+} agc_ckpt_t;
+
+typedef struct {
+    agc_ckpt_t *ckpts;          // Checkpoint 0 is the base
+    size_t count, capacity;
+    agc_word_t *data;           // Stored pages, in page order within a checkpoint
+    size_t data_used, data_capacity;
+} agc_ckpt_log_t;
+
+void agc_ckpt_init(agc_ckpt_log_t *log);
+void agc_ckpt_free(agc_ckpt_log_t *log);
+
+// Forget every checkpoint; the next one taken is a new base
+void agc_ckpt_reset(agc_ckpt_log_t *log);
+
+// Take the next checkpoint of cpu; it is log->count - 1 afterwards.
+// Returns false (and leaves cpu->dirty alone) if out of memory.
+bool agc_ckpt_take(agc_ckpt_log_t *log, agc_cpu_t *cpu);
+
+// Erasable words stored by checkpoint i
+size_t agc_ckpt_words(const agc_ckpt_log_t *log, size_t i);
+
+// Rebuild checkpoint i as a full snapshot; false if there is no such one
+bool agc_ckpt_rebuild(const agc_ckpt_log_t *log, size_t i, agc_snapshot_t *snap);
+
+#endif // AGC_CHECKPOINT_H
@@ -0,0 +1,62 @@
+#ifndef AGC_COREFILE_H
+#define AGC_COREFILE_H
+
+#include <stddef.h>
+#include "agc_types.h"
+#include "agc_cpu.h"
+
+/*
+ * Persistent erasable memory.
+ *
+ * The AGC's erasable memory was magnetic core and kept its contents with
+ * the power off. A core file gives an instance the same property: its
+ * erasable words live in a file mapped shared into memory, and
+ * cpu->erasable points straight at them. Instructions, agc_memory_write()
+ * and snapshot restores all write the mapping, so there is no save step;
+ * whatever the instance last wrote is in the file and survives the
+ * process exiting or being killed. agc_corefile_sync() (msync) is the
+ * checkpoint that also makes it survive a crash of the host itself.
+ *
+ * File layout, host byte order: an agc_corefile_header_t padded to
+ * AGC_COREFILE_OFFSET bytes, then AGC_RAM_SIZE words (bank n at word
+ * n * 1024). A new file starts with erasable memory cleared.
+ *
+ * A file backs at most one instance at a time. agc_cpu_reset() returns
+ * the instance to its own cleared storage and leaves the file as it was.
+ */
+
+#define AGC_COREFILE_MAGIC   0x45434741u   // "AGCE"
+#define AGC_COREFILE_VERSION 1
+#define AGC_COREFILE_OFFSET  4096           // Words start on their own page
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t word_size;         // sizeof(agc_word_t)
+    uint32_t words;             // AGC_RAM_SIZE
+} agc_corefile_header_t;
+
+typedef struct agc_corefile {
+    void *base;                 // Whole file, mapped shared; NULL when closed
+    size_t size;
+    agc_word_t *words;          // Erasable image inside the mapping
+    agc_cpu_t *cpu;             // Instance it backs, NULL if none
+    bool created;               // Open made a new file
+} agc_corefile_t;
+
+// Map path, creating it if missing. Returns false if it cannot be
+// opened or mapped, or is not a core file of this layout.
+bool agc_corefile_open(agc_corefile_t *file, const char *path);
+
+// Detach the instance it backs (see agc_corefile_attach) and unmap
+void agc_corefile_close(agc_corefile_t *file);
+
+// Run cpu on the file's erasable image, as left by its last user. NULL
+// detaches: the instance goes back to its own storage with a copy of
+// the file's contents, so its state does not change.
+void agc_corefile_attach(agc_cpu_t *cpu, agc_corefile_t *file);
+
+// Checkpoint: write the mapping to the file and wait for it
+bool agc_corefile_sync(agc_corefile_t *file);
+
+#endif // AGC_COREFILE_H
@@ -1,14 +1,63 @@
 #ifndef AGC_CPU_H
 #define AGC_CPU_H
 
+#include <stddef.h>
 #include "agc_types.h"
 
+#ifdef AGC_SUPERBLOCKS
+#include "agc_superblock.h"
+#endif
+
+// Sizes of AGC memory regions
+#define AGC_RAM_SIZE 2048      // 2K words of erasable memory
+#define AGC_ROM_SIZE 36864     // 36K words of fixed memory
+#define AGC_RAM_BYTES (AGC_RAM_SIZE * sizeof(agc_word_t))
+
+// Erasable memory is tracked for checkpoints in pages of 32 words,
+// one bit each in agc_cpu_t.dirty (see agc_checkpoint.h)
+#define AGC_DIRTY_SHIFT 5
+#define AGC_DIRTY_WORDS (1 << AGC_DIRTY_SHIFT)
+#define AGC_DIRTY_PAGES (AGC_RAM_SIZE >> AGC_DIRTY_SHIFT)
+
+// Maximum number of execution breakpoints checked by agc_cpu_run()
+#define AGC_MAX_BREAKPOINTS 16
+
+/*
+ * Reasons agc_cpu_run() stops. The same bits form its stop_mask, which
+ * selects the conditions checked after each instruction; reaching the
+ * instruction limit always stops the run.
+ */
+typedef enum {
+    AGC_STOP_NONE       = 0,
+    AGC_STOP_COUNT      = 1 << 0,   // max_instructions executed
+    AGC_STOP_BREAKPOINT = 1 << 1,   // Z reached a breakpoint (list or agc_debug.h map)
+    AGC_STOP_Z_RANGE    = 1 << 2,   // Z entered [stop_z_lo, stop_z_hi]
+    AGC_STOP_IO_WRITE   = 1 << 3,   // an OUT channel was written (no instruction writes one:
+                                    // only host or event calls to agc_io_write() raise it)
+    AGC_STOP_CYCLE      = 1 << 4,   // cycle_count reached stop_cycle
+    AGC_STOP_WATCH      = 1 << 5,   // a watchpoint was hit (agc_debug.h)
+    AGC_STOP_RUPT       = 1 << 6,   // an interrupt request is pending (agc_sched.h)
+} agc_stop_reason_t;
+
+struct agc_rope;   // Rope image, see agc_memory.h
+struct agc_decoded;
+struct agc_prof;   // Execution profile, see agc_profiler.h
+struct agc_debug;  // Breakpoint/watchpoint maps, see agc_debug.h
+struct agc_trace;  // Instruction trace ring, see agc_trace.h
+struct agc_channels; // Peripheral channel queues, see agc_channels.h
+struct agc_sched;  // Event scheduler, see agc_sched.h
+struct agc_corefile; // Persistent erasable memory, see agc_corefile.h
+
 /*
  * CPU state of the Apollo Guidance Computer.
  * This structure models the hardware registers exactly as in AGC Block II.
+ *
+ * Each agc_cpu_t is a complete emulated computer: it owns its erasable
+ * memory and references a rope image that is only ever read. Instances
+ * share no mutable state, so N of them can run on N threads.
  */
 
-typedef struct {
+typedef struct agc_cpu {
 
     // Main registers
     agc_word_t A;   // Accumulator
@@ -27,14 +76,106 @@ typedef struct {
 
     // Internal CPU state
     agc_word_t current_instruction;
-    uint64_t cycle_count;
+    uint64_t cycle_count;               // Emulated time in MCTs (see agc_timing.h)
+
+    // Stop conditions for agc_cpu_run()
+    agc_word_t breakpoints[AGC_MAX_BREAKPOINTS];
+    uint8_t breakpoint_count;
+    agc_word_t stop_z_lo, stop_z_hi;
+    uint64_t stop_cycle;
+    uint16_t out_written;               // Bit n set when OUT[n] was written
+
+    // Breakpoint/watchpoint maps (see agc_debug.h)
+    struct agc_debug *debug;            // NULL when none attached
+    uint8_t debug_armed;                // AGC_DEBUG_* kinds with a point set, 0 if none
+    uint8_t debug_hit;                  // AGC_DEBUG_* kinds hit (cleared by agc_cpu_run())
+    uint32_t debug_hit_phys;            // Physical word of the last hit
+
+    struct agc_trace *trace;            // Ring recording each instruction, NULL if not tracing
+    struct agc_channels *channels;      // Queues to peripheral threads, NULL if none
+
+    // Idle loop fast-forward (see agc_dispatch.c)
+    bool idle_skip;                     // Skip no-progress loops in agc_cpu_run()/exec()
+
+    // Timed events (see agc_sched.h)
+    struct agc_sched *sched;            // NULL when none attached
+    uint64_t next_event;                // cycle_count of the next scheduled event, UINT64_MAX if none
+    uint16_t rupt_pending;              // Bit n set while interrupt n is requested
+
+#ifdef AGC_SUPERBLOCKS
+    agc_superblock_t superblocks[AGC_SB_SLOTS];
+#endif
+
+#ifdef AGC_PROFILER
+    struct agc_prof *prof;              // Counters while profiling, NULL otherwise
+#endif
+
+    // Memory context
+    agc_word_t *erasable;               // Erasable memory: erasable_store or a core file
+    struct agc_corefile *corefile;      // Core file mapped as erasable, NULL if none
+    uint64_t dirty;                     // Bit n set when erasable page n was written
+                                        // since the last agc_ckpt_take()
+    const struct agc_rope *rope;        // Fixed memory (shared, read-only)
+    agc_word_t erasable_store[AGC_RAM_SIZE]; // Owned erasable storage
+
+    // Bank translation cache, derived from EB/FB/rope by agc_memory_sync_banks()
+    agc_word_t *erasable_bank;          // First word of the bank selected by EB
+    const agc_word_t *page[32];         // Base of each 1K page of the 15-bit address space,
+                                        // NULL where the page lies past the end of the rope
+    const struct agc_decoded *decoded_page[32]; // Pre-decoded rope words for each page,
+                                        // NULL for erasable and past the end of the rope
+    uint16_t bank_key;                  // EB | FB << 8 the cache was built for
 
 } agc_cpu_t;
 
-// Initialize CPU to reset state
+// The JNI bridge hands registers and channels to Java as direct buffers,
+// and Java reads them at these byte offsets (see bridge/agc_jni.h)
+#define AGC_JNI_REG_A    0
+#define AGC_JNI_REG_L    2
+#define AGC_JNI_REG_Q    4
+#define AGC_JNI_REG_Z    6
+#define AGC_JNI_REG_EB   8
+#define AGC_JNI_REG_FB   9
+#define AGC_JNI_REG_BB   10
+#define AGC_JNI_REG_SIZE 11
+#define AGC_JNI_CHAN_OUT 32
+
+_Static_assert(offsetof(agc_cpu_t, A) == AGC_JNI_REG_A, "A offset");
+_Static_assert(offsetof(agc_cpu_t, L) == AGC_JNI_REG_L, "L offset");
+_Static_assert(offsetof(agc_cpu_t, Q) == AGC_JNI_REG_Q, "Q offset");
+_Static_assert(offsetof(agc_cpu_t, Z) == AGC_JNI_REG_Z, "Z offset");
+_Static_assert(offsetof(agc_cpu_t, EB) == AGC_JNI_REG_EB, "EB offset");
+_Static_assert(offsetof(agc_cpu_t, FB) == AGC_JNI_REG_FB, "FB offset");
+_Static_assert(offsetof(agc_cpu_t, BB) == AGC_JNI_REG_BB, "BB offset");
+_Static_assert(offsetof(agc_cpu_t, OUT) - offsetof(agc_cpu_t, IN) == AGC_JNI_CHAN_OUT, "OUT offset");
+
+// Initialize CPU to reset state (clears erasable, detaches a core file,
+// attaches the default rope)
 void agc_cpu_reset(agc_cpu_t *cpu);
 
 // Execute one instruction (cycle-accurate step)
 void agc_cpu_step(agc_cpu_t *cpu);
 
+// One instruction through the switch decoder, without profiling;
+// agc_cpu_step() of the default build and the step of the profiled loop
+void agc_cpu_step_switch(agc_cpu_t *cpu);
+
+// Execute count instructions back to back; returns the number executed.
+// Built with AGC_THREADED_DISPATCH this uses the threaded interpreter core.
+uint64_t agc_cpu_exec(agc_cpu_t *cpu, uint64_t count);
+
+// Run up to max_instructions, checking the stop_mask conditions after each
+// one. Returns why the run stopped; executed (may be NULL) gets the count.
+agc_stop_reason_t agc_cpu_run(agc_cpu_t *cpu, uint64_t max_instructions,
+                              uint32_t stop_mask, uint64_t *executed);
+
+// Stop condition setup
+bool agc_cpu_add_breakpoint(agc_cpu_t *cpu, agc_word_t address);
+void agc_cpu_clear_breakpoints(agc_cpu_t *cpu);
+void agc_cpu_set_stop_range(agc_cpu_t *cpu, agc_word_t lo, agc_word_t hi);
+
+// Write an output channel (records the write for AGC_STOP_IO_WRITE and
+// queues it for an attached peripheral, see agc_channels.h)
+void agc_io_write(agc_cpu_t *cpu, uint8_t channel, agc_word_t value);
+
 #endif // AGC_CPU_H
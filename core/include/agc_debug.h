@@ -0,0 +1,81 @@
+#ifndef AGC_DEBUG_H
+#define AGC_DEBUG_H
+
+#include <stddef.h>
+#include "agc_types.h"
+#include "agc_cpu.h"
+#include "agc_memory.h"
+
+/*
+ * Breakpoints and watchpoints.
+ *
+ * Points are bank-qualified: each names a physical word (see
+ * agc_phys_index()), so a breakpoint at 02100 in FB 3 does not fire in
+ * FB 4, and EB/FB values that alias the same bank hit the same point.
+ * agc_debug_t holds one bitmap per kind over every physical word, so
+ * checking a point is a bit test whatever the number set.
+ *
+ * An instance with a map attached keeps cpu->debug_armed, the kinds
+ * with at least one point set. While it is zero nothing is checked:
+ * agc_cpu_run()/agc_cpu_exec() take their usual fast paths and
+ * agc_memory_read()/agc_memory_write() test one flag. Once armed, runs
+ * step through agc_debug_step() (no idle skip, no superblocks).
+ *
+ * Hits are latched in cpu->debug_hit. Execution breakpoints hit when Z
+ * reaches the word, before it executes; watchpoints hit on the operand
+ * access of an instruction, which completes first, and on host accesses
+ * through agc_memory_read()/agc_memory_write(). Instruction fetches are
+ * not reads. agc_cpu_run() clears the latch on entry and stops with
+ * AGC_STOP_BREAKPOINT or AGC_STOP_WATCH when those are in its mask.
+ *
+ * The bank-agnostic breakpoint list in agc_cpu_t (agc_cpu_add_breakpoint)
+ * is separate and keeps working on the fast paths.
+ */
+
+typedef enum {
+    AGC_DEBUG_EXEC  = 1 << 0,   // Execution breakpoint
+    AGC_DEBUG_READ  = 1 << 1,   // Read watchpoint
+    AGC_DEBUG_WRITE = 1 << 2,   // Write watchpoint
+} agc_debug_kind_t;
+
+#define AGC_DEBUG_KINDS     3
+#define AGC_DEBUG_MAP_WORDS ((AGC_PHYS_WORDS + 63) / 64)
+
+typedef struct agc_debug {
+    uint64_t map[AGC_DEBUG_KINDS][AGC_DEBUG_MAP_WORDS];    // By kind bit: exec, read, write
+    uint32_t count[AGC_DEBUG_KINDS];                        // Points set in each map
+} agc_debug_t;
+
+static inline bool agc_debug_test(const agc_debug_t *dbg, int kind_bit, uint32_t phys) {
+    return (dbg->map[kind_bit][phys >> 6] >> (phys & 63)) & 1;
+}
+
+// Clear every point
+void agc_debug_init(agc_debug_t *dbg);
+
+// Check points from dbg (NULL detaches). One map may back several
+// instances; call agc_debug_attach() again on each after changing it
+// through another instance so its armed flag is refreshed.
+void agc_debug_attach(agc_cpu_t *cpu, agc_debug_t *dbg);
+
+// Set or remove points of the given kinds at addr, with bank taken as EB
+// for erasable addresses and FB for fixed ones. Returns false if no map
+// is attached.
+bool agc_debug_set(agc_cpu_t *cpu, unsigned kinds, uint8_t bank, agc_word_t addr, bool on);
+
+// Remove every point of the given kinds
+void agc_debug_clear(agc_cpu_t *cpu, unsigned kinds);
+
+// Fill out with up to max physical words that have a point of kind set,
+// in address order; returns how many were filled
+size_t agc_debug_list(const agc_debug_t *dbg, agc_debug_kind_t kind, uint32_t *out, size_t max);
+
+// Latch a hit if a watchpoint of kind covers addr under the current
+// banks. Called by agc_memory_read()/agc_memory_write() when armed.
+void agc_debug_access(agc_cpu_t *cpu, agc_word_t addr, agc_debug_kind_t kind);
+
+// One instruction with the armed points checked; what agc_cpu_step()
+// and the run loops use while cpu->debug_armed is set
+void agc_debug_step(agc_cpu_t *cpu);
+
+#endif // AGC_DEBUG_H
@@ -1,8 +1,10 @@
 #ifndef AGC_INSTRUCTIONS_H
 #define AGC_INSTRUCTIONS_H
 
+#include <stddef.h>
 #include "agc_types.h"
 #include "agc_cpu.h"
+#include "agc_memory.h"
 
 /*
  * Opcode layout in the AGC (Block II):
@@ -37,6 +39,8 @@ void agc_execute_instruction(agc_cpu_t *cpu, agc_word_t instr);
 /*
  * Individual instruction handlers.
  * These will be implemented in agc_instructions.c.
+ * They access memory through the bank translation cache, which
+ * agc_execute_instruction() brings up to date before dispatching.
  */
 
 void agc_instr_TC(agc_cpu_t *cpu, uint16_t address);     // Transfer Control (opcode 0)
@@ -44,4 +48,49 @@ void agc_instr_XCH(agc_cpu_t *cpu, uint16_t address);    // Exchange (opcode 1)
 void agc_instr_TS(agc_cpu_t *cpu, uint16_t address);     // Transfer to Storage (opcode 2)
 void agc_instr_CA(agc_cpu_t *cpu, uint16_t address);     // Clear and Add (opcode 3)
 
+// Handlers indexed by opcode; unimplemented opcodes map to a no-op
+typedef void (*agc_instr_fn)(agc_cpu_t *cpu, uint16_t address);
+extern const agc_instr_fn agc_instr_table[8];
+
+// Memory cycle times (MCT) taken by each opcode, see agc_timing.h
+extern const uint8_t agc_instr_mct[8];
+
+// Mnemonic of each opcode
+extern const char *const agc_instr_names[8];
+
+// Disassemble one word as "<mnemonic> <address>"
+void agc_disasm(agc_word_t instr, char *buf, size_t size);
+
+// Operand accesses made by each opcode (AGC_OPERAND_* bits)
+#define AGC_OPERAND_READ  1
+#define AGC_OPERAND_WRITE 2
+extern const uint8_t agc_instr_operand[8];
+
+/*
+ * Instruction semantics, shared by the agc_instr_* handlers above and
+ * the threaded interpreter core, which inlines them into its dispatch loop.
+ */
+
+// TC - jump to the given address
+static inline void agc_op_TC(agc_cpu_t *cpu, uint16_t address) {
+    cpu->Z = agc_normalize(address);
+}
+
+// XCH - swap A with memory[address]
+static inline void agc_op_XCH(agc_cpu_t *cpu, uint16_t address) {
+    agc_word_t temp = agc_memory_read_banked(cpu, address);
+    agc_memory_write_banked(cpu, address, cpu->A);
+    cpu->A = temp;
+}
+
+// TS - store A into memory[address] (ignored for fixed memory)
+static inline void agc_op_TS(agc_cpu_t *cpu, uint16_t address) {
+    agc_memory_write_banked(cpu, address, cpu->A);
+}
+
+// CA - load memory[address] into A
+static inline void agc_op_CA(agc_cpu_t *cpu, uint16_t address) {
+    cpu->A = agc_memory_read_banked(cpu, address);
+}
+
 #endif // AGC_INSTRUCTIONS_H
@@ -0,0 +1,81 @@
+#ifndef AGC_JOURNAL_H
+#define AGC_JOURNAL_H
+
+#include <stddef.h>
+#include "agc_types.h"
+#include "agc_cpu.h"
+#include "agc_snapshot.h"
+
+/*
+ * Deterministic record/replay.
+ *
+ * Execution is deterministic given the starting state, the rope and the
+ * inputs that reach the instance from outside. A journal stores only
+ * those: a snapshot taken when recording begins, then one 16-byte entry
+ * per input (IN channel writes, memory pokes, bank switches and opaque
+ * host events), each stamped with the cycle_count at which it arrived.
+ * Recording adds nothing to the instruction loop.
+ *
+ * Replay restores the snapshot and runs at full speed up to each entry's
+ * cycle, applies it, and finishes at the cycle where recording ended,
+ * reproducing the recorded run bit for bit. The rope is not journaled;
+ * replay with the same rope attached. Inputs from peripheral threads are
+ * only journaled if the channels are given the journal (agc_chan_journal);
+ * replay into an instance without channels attached.
+ */
+
+typedef enum {
+    AGC_JOURNAL_IN = 1,         // IN[addr] = value
+    AGC_JOURNAL_POKE,           // memory[addr] = value through current banks
+    AGC_JOURNAL_EB,             // EB = value
+    AGC_JOURNAL_FB,             // FB = value
+    AGC_JOURNAL_EXTERNAL,       // Host event: id in addr, payload in value
+} agc_journal_kind_t;
+
+typedef struct {
+    uint64_t cycle;             // cycle_count when the input arrived
+    uint8_t kind;               // agc_journal_kind_t
+    uint8_t reserved;
+    agc_word_t addr;
+    agc_word_t value;
+    uint16_t reserved2;
+} agc_journal_entry_t;
+
+typedef struct agc_journal agc_journal_t;
+
+// Applies AGC_JOURNAL_EXTERNAL entries, when set
+typedef void (*agc_journal_event_fn)(agc_cpu_t *cpu, const agc_journal_entry_t *entry, void *ctx);
+
+struct agc_journal {
+    agc_snapshot_t start;       // State when recording began
+    agc_journal_entry_t *entries;
+    size_t count;
+    size_t capacity;
+    uint64_t end_cycle;         // cycle_count when recording ended
+    bool recording;
+
+    agc_journal_event_fn on_external;
+    void *ctx;
+};
+
+void agc_journal_init(agc_journal_t *j);
+void agc_journal_free(agc_journal_t *j);
+
+// Start recording from the current state of cpu (drops earlier entries)
+void agc_journal_begin(agc_journal_t *j, const agc_cpu_t *cpu);
+
+// Stop recording; the journal now ends at the current cycle
+void agc_journal_end(agc_journal_t *j, const agc_cpu_t *cpu);
+
+// Apply an input to cpu, and log it if j is recording (j may be NULL)
+bool agc_journal_input(agc_journal_t *j, agc_cpu_t *cpu, agc_journal_kind_t kind,
+                       agc_word_t addr, agc_word_t value);
+
+// Replay into cpu (which must have the recording's rope attached)
+bool agc_journal_replay(const agc_journal_t *j, agc_cpu_t *cpu);
+
+// Journal files: header, start snapshot, entries
+bool agc_journal_save(const agc_journal_t *j, const char *path);
+bool agc_journal_load(agc_journal_t *j, const char *path);
+
+#endif // AGC_JOURNAL_H
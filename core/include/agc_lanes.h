@@ -0,0 +1,64 @@
+#ifndef AGC_LANES_H
+#define AGC_LANES_H
+
+#include "agc_types.h"
+#include "agc_cpu.h"
+#include "agc_memory.h"
+
+/*
+ * Lockstep execution of AGC_LANES instances (experimental).
+ *
+ * Registers and erasable memory are stored structure-of-arrays: one row
+ * of AGC_LANES words per register and per erasable address. Lanes that
+ * share Z, EB, FB and the fetched instruction word form a group, and the
+ * group executes that instruction once with vector loads, compares and
+ * masked blends. When lanes diverge (different code in erasable memory,
+ * a bank switch, a TC taken by only some of them) the step is repeated
+ * for each remaining group, so every lane still advances exactly one
+ * instruction per step and ends in the same state agc_cpu_exec() would
+ * produce. Lanes that keep agreeing cost one dispatch per step.
+ *
+ * The kernels use AVX2 when the file is compiled with it (-mavx2),
+ * SSE2 otherwise on x86-64, and plain loops elsewhere. Where the
+ * compiler takes -mavx2 the build adds agc_core_avx2, tested by
+ * test_basic_avx2 and measured by bench_lockstep_avx2.
+ *
+ * IN/OUT channels, stop conditions and scheduled events are not
+ * modelled; the rope is shared by all lanes.
+ */
+
+#define AGC_LANES 16
+
+typedef struct {
+    _Alignas(32) agc_word_t A[AGC_LANES];
+    _Alignas(32) agc_word_t L[AGC_LANES];
+    _Alignas(32) agc_word_t Q[AGC_LANES];
+    _Alignas(32) agc_word_t Z[AGC_LANES];
+    _Alignas(32) agc_word_t EB[AGC_LANES];
+    _Alignas(32) agc_word_t FB[AGC_LANES];
+    _Alignas(32) agc_word_t current_instruction[AGC_LANES];
+    _Alignas(32) agc_word_t pending_mct[AGC_LANES];    // Not yet in cycle_count
+    uint64_t cycle_count[AGC_LANES];
+    uint8_t BB[AGC_LANES];
+
+    // erasable[addr][lane]
+    _Alignas(32) agc_word_t erasable[AGC_RAM_SIZE][AGC_LANES];
+
+    const agc_rope_t *rope;
+    uint64_t steps;             // Lockstep steps executed
+    uint64_t groups;            // Instruction dispatches; == steps while lanes agree
+} agc_lanes_t;
+
+// Put every lane in reset state running from rope (NULL = default rope)
+void agc_lanes_init(agc_lanes_t *lanes, const agc_rope_t *rope);
+
+// Copy an instance's registers, banks, time and erasable memory into a lane
+void agc_lanes_load(agc_lanes_t *lanes, int lane, const agc_cpu_t *cpu);
+
+// Copy a lane back into an instance (IN/OUT and the rope are left as is)
+void agc_lanes_store(agc_lanes_t *lanes, int lane, agc_cpu_t *cpu);
+
+// Advance every lane by steps instructions
+void agc_lanes_exec(agc_lanes_t *lanes, uint64_t steps);
+
+#endif // AGC_LANES_H
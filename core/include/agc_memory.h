@@ -4,24 +4,120 @@
 #include "agc_types.h"
 #include "agc_cpu.h"
 
-// Sizes of AGC memory regions
-#define AGC_RAM_SIZE 2048      // 2K words of erasable memory
-#define AGC_ROM_SIZE 36864     // 36K words of fixed memory
+// Bank size constants
+#define AGC_ERASE_BANK_SIZE  02000   // 1024 words (1K) per erasable bank
+#define AGC_FIXED_BANK_SIZE  010000  // 4096 words (4K) per fixed bank
+
+/*
+ * Pre-decoded rope word.
+ * Rope memory never changes once loaded, so each word is decoded once
+ * at load time and the step loop reads the result instead of the word.
+ * The operand field is 10 bits wide, so every operand is already an
+ * erasable-bank-relative address and needs no further resolution.
+ */
+typedef struct agc_decoded {
+    agc_word_t word;     // Original instruction word
+    uint16_t address;    // Operand (bank-relative erasable address)
+    uint8_t handler;     // Index into agc_instr_table
+} agc_decoded_t;
+
+/*
+ * Rope (fixed memory) image with its decoded side-table.
+ */
+typedef struct agc_rope {
+    agc_word_t words[AGC_ROM_SIZE];
+    agc_decoded_t decoded[AGC_ROM_SIZE];
+    uint32_t generation;    // Changes on every load or word write
+} agc_rope_t;
+
+/*
+ * Physical words, numbered erasable first (0 .. AGC_RAM_SIZE-1) and then
+ * rope words, and the one a CPU address selects under the given banks.
+ * Addresses past the end of the rope map to its last word, which is what
+ * they read.
+ */
+#define AGC_PHYS_WORDS (AGC_RAM_SIZE + AGC_ROM_SIZE)
+
+static inline uint32_t agc_phys_index(uint8_t eb, uint8_t fb, agc_word_t addr) {
+    addr &= 077777;
+    if (addr < AGC_ERASE_BANK_SIZE)
+        return (uint32_t)(eb % (AGC_RAM_SIZE / AGC_ERASE_BANK_SIZE)) * AGC_ERASE_BANK_SIZE + addr;
+
+    uint32_t phys = (uint32_t)(fb % (AGC_ROM_SIZE / AGC_FIXED_BANK_SIZE)) * AGC_FIXED_BANK_SIZE +
+                    (uint32_t)(((addr >> 10) & 037) - 1) * AGC_ERASE_BANK_SIZE + (addr & 01777);
+    return AGC_RAM_SIZE + (phys < AGC_ROM_SIZE ? phys : AGC_ROM_SIZE - 1);
+}
 
 // Memory access API
 agc_word_t agc_memory_read(agc_cpu_t *cpu, agc_word_t address);
 void agc_memory_write(agc_cpu_t *cpu, agc_word_t address, agc_word_t value);
 
-// ROM loading (for Colossus/Luminary binaries)
+// Rebuild the bank translation cache after EB/FB or the rope changed
+void agc_memory_rebank(agc_cpu_t *cpu);
+
+// Refresh the bank translation cache if EB/FB changed
+// (agc_memory_attach_rope() rebuilds it on its own)
+static inline void agc_memory_sync_banks(agc_cpu_t *cpu) {
+    if ((uint16_t)(cpu->EB | cpu->FB << 8) != cpu->bank_key)
+        agc_memory_rebank(cpu);
+}
+
+// Record a write to erasable word phys for the next checkpoint
+static inline void agc_memory_mark(agc_cpu_t *cpu, uint32_t phys) {
+    cpu->dirty |= (uint64_t)1 << (phys >> AGC_DIRTY_SHIFT);
+}
+
+_Static_assert(AGC_DIRTY_PAGES == 64, "cpu->dirty holds one bit per page");
+
+/*
+ * Banked access through the translation cache.
+ * The caller must have run agc_memory_sync_banks() since the last change
+ * to EB/FB; agc_cpu_step() does this once per instruction.
+ */
+static inline agc_word_t agc_memory_read_banked(const agc_cpu_t *cpu, agc_word_t addr) {
+    const agc_word_t *page = cpu->page[(addr >> 10) & 037];
+    if (page)
+        return page[addr & 01777];
+
+    // Reads past the end of the rope return its last word
+    return cpu->rope->words[AGC_ROM_SIZE - 1];
+}
+
+static inline void agc_memory_write_banked(agc_cpu_t *cpu, agc_word_t addr, agc_word_t value) {
+    addr &= 077777;
+    // Writes to fixed memory (ROM) are ignored
+    if (addr < AGC_ERASE_BANK_SIZE) {
+        cpu->erasable_bank[addr] = agc_normalize(value);
+        agc_memory_mark(cpu, (uint32_t)(cpu->erasable_bank - cpu->erasable) + addr);
+    }
+}
+
+// ROM loading (for Colossus/Luminary binaries); see agc_rope.h for
+// format detection and shared read-only images
 void agc_memory_load_rom(const char *path);
 
 bool agc_load_rom(const char *filename);
 
+// Load a ROM binary into a caller-owned rope image and decode it
+bool agc_rope_load(agc_rope_t *rope, const char *filename);
+
+// Rebuild the decoded side-table after writing rope->words directly.
+// Also gives the rope a new generation, so code cached from its old
+// words (see agc_superblock.h) is no longer used.
+void agc_rope_decode(agc_rope_t *rope);
+
+// Rope image shared by instances that did not attach their own
+const agc_rope_t *agc_default_rope(void);
+
+// Attach a rope image to an instance (NULL selects the default rope).
+// The image is never written, so any number of instances may share it.
+void agc_memory_attach_rope(agc_cpu_t *cpu, const agc_rope_t *rope);
+
 // Erasable memory helpers (for testing)
-void agc_erasable_set(uint8_t bank, uint16_t addr, agc_word_t value);
-agc_word_t agc_erasable_get(uint8_t bank, uint16_t addr);
+void agc_erasable_set(agc_cpu_t *cpu, uint8_t bank, uint16_t addr, agc_word_t value);
+agc_word_t agc_erasable_get(const agc_cpu_t *cpu, uint8_t bank, uint16_t addr);
 
-// ROM/Fixed memory helpers (for testing)
+// ROM/Fixed memory helpers for the default rope (for testing)
 void agc_rom_set(uint32_t addr, agc_word_t value);
 agc_word_t agc_rom_get(uint32_t addr);
 
@@ -0,0 +1,106 @@
+#ifndef AGC_PROFILER_H
+#define AGC_PROFILER_H
+
+#include <stddef.h>
+#include "agc_types.h"
+#include "agc_cpu.h"
+#include "agc_memory.h"
+
+/*
+ * Execution profiler.
+ *
+ * Built with AGC_PROFILER, an instance with a profile attached counts
+ * every instruction it executes: per physical word of erasable and
+ * fixed memory, per opcode, and every change of EB or FB (by the bank
+ * entered). Counters are flat arrays inside agc_prof_t, so recording is
+ * a few increments and never allocates.
+ *
+ * While a profile is attached, agc_cpu_run() and agc_cpu_exec() step
+ * one instruction at a time (no idle skip, no superblocks) so every
+ * instruction is counted. With no profile attached the interpreter
+ * cores never look at it, and without AGC_PROFILER the hook is
+ * compiled out entirely.
+ */
+
+typedef struct agc_prof {
+    uint64_t erasable[AGC_RAM_SIZE];    // By physical erasable word
+    uint64_t fixed[AGC_ROM_SIZE];       // By physical rope word
+    uint64_t past_end;                  // Fetches past the end of the rope
+    uint64_t opcode[8];
+    uint64_t instructions;
+
+    uint64_t eb_switches, fb_switches;
+    uint64_t eb_enter[256];             // Switches into each EB value
+    uint64_t fb_enter[256];             // Switches into each FB value
+    uint16_t bank_key;                  // EB | FB << 8 at the last instruction
+} agc_prof_t;
+
+// One counted location, as reported by agc_prof_hottest()
+typedef struct {
+    bool fixed;                         // Fixed (rope) or erasable memory
+    uint8_t bank;
+    agc_word_t addr;                    // CPU address within the bank
+    agc_word_t word;                    // Instruction word there
+    uint64_t count;
+} agc_prof_hot_t;
+
+static inline void agc_prof_record(agc_prof_t *prof, const agc_cpu_t *cpu) {
+    uint16_t key = (uint16_t)(cpu->EB | cpu->FB << 8);
+    if (key != prof->bank_key) {
+        if ((key ^ prof->bank_key) & 0xff) {
+            prof->eb_switches++;
+            prof->eb_enter[cpu->EB]++;
+        }
+        if ((key ^ prof->bank_key) >> 8) {
+            prof->fb_switches++;
+            prof->fb_enter[cpu->FB]++;
+        }
+        prof->bank_key = key;
+    }
+
+    // Same translation as agc_memory_rebank(), done here on the raw
+    // registers so recording does not depend on the bank cache
+    agc_word_t z = cpu->Z, word;
+    if (z < AGC_ERASE_BANK_SIZE) {
+        int phys = (cpu->EB % (AGC_RAM_SIZE / AGC_ERASE_BANK_SIZE)) * AGC_ERASE_BANK_SIZE + z;
+        prof->erasable[phys]++;
+        word = cpu->erasable[phys];
+    } else {
+        int phys = (cpu->FB % (AGC_ROM_SIZE / AGC_FIXED_BANK_SIZE)) * AGC_FIXED_BANK_SIZE +
+                   (((z >> 10) & 037) - 1) * AGC_ERASE_BANK_SIZE + (z & 01777);
+        if (phys < AGC_ROM_SIZE) {
+            prof->fixed[phys]++;
+            word = cpu->rope->words[phys];
+        } else {
+            prof->past_end++;
+            word = cpu->rope->words[AGC_ROM_SIZE - 1];
+        }
+    }
+    prof->opcode[(word >> 12) & 07]++;
+    prof->instructions++;
+}
+
+#ifdef AGC_PROFILER
+#define AGC_PROF_RECORD(cpu) \
+    do { if ((cpu)->prof) agc_prof_record((cpu)->prof, (cpu)); } while (0)
+#else
+#define AGC_PROF_RECORD(cpu) ((void)0)
+#endif
+
+// Clear every counter
+void agc_prof_reset(agc_prof_t *prof);
+
+// Start counting into prof (NULL stops). Banks are counted as switched
+// from the instance's current EB/FB. Returns false when built without
+// AGC_PROFILER.
+bool agc_prof_attach(agc_cpu_t *cpu, agc_prof_t *prof);
+
+// Fill out with up to max of the most executed locations, hottest first;
+// returns how many were filled. cpu supplies the words for disassembly.
+size_t agc_prof_hottest(const agc_prof_t *prof, const agc_cpu_t *cpu,
+                        agc_prof_hot_t *out, size_t max);
+
+// Write every non-zero counter to a tab-separated text file
+bool agc_prof_export(const agc_prof_t *prof, const char *path);
+
+#endif // AGC_PROFILER_H
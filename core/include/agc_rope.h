@@ -0,0 +1,86 @@
+#ifndef AGC_ROPE_H
+#define AGC_ROPE_H
+
+#include <stddef.h>
+#include "agc_types.h"
+#include "agc_memory.h"
+
+/*
+ * Rope image loading.
+ *
+ * The image file is mmap'd read-only and converted to host words in a
+ * single pass, so no intermediate copy or per-word stdio call is made.
+ * Three on-disk formats are understood:
+ *
+ *   - .bin        16-bit big-endian words (the usual rope dump)
+ *   - host dump   16-bit words in host byte order (a raw memory copy)
+ *   - .binsource  yaYUL-style octal text: 5-digit words separated by
+ *                 whitespace, ';' comments and BANK=<octal> directives
+ *
+ * With AGC_ROPE_AUTO the format is taken from a .binsource extension or
+ * from the contents: text is octal source, binary is big-endian unless
+ * only the host byte order leaves every word within 15 bits.
+ *
+ * agc_rope_map() returns a rope that lives in its own read-only mapping.
+ * Attach it to any number of instances with agc_memory_attach_rope();
+ * the words and decoded side-table exist exactly once.
+ */
+
+typedef enum {
+    AGC_ROPE_AUTO = 0,
+    AGC_ROPE_BIN,           // Big-endian 16-bit words
+    AGC_ROPE_HOST,          // Host-endian 16-bit words
+    AGC_ROPE_BINSOURCE,     // yaYUL octal text
+} agc_rope_format_t;
+
+typedef struct {
+    agc_rope_format_t format;   // Format actually parsed
+    size_t file_size;           // Bytes in the image file
+    size_t words;               // Words loaded; less than AGC_ROM_SIZE for a short image
+    uint64_t checksum;          // agc_rope_checksum() of the loaded rope
+} agc_rope_info_t;
+
+// Load an image into a caller-owned rope and decode it. Returns false,
+// leaving the rope untouched, if the file is missing, truncated mid-word,
+// larger than the rope or not valid octal source. info may be NULL.
+bool agc_rope_load_format(agc_rope_t *rope, const char *path,
+                          agc_rope_format_t format, agc_rope_info_t *info);
+
+// Same, into the default rope image
+bool agc_load_rom_format(const char *path, agc_rope_format_t format, agc_rope_info_t *info);
+
+// Load an image into a new read-only mapping; NULL on failure
+const agc_rope_t *agc_rope_map(const char *path, agc_rope_format_t format, agc_rope_info_t *info);
+
+// Release a rope returned by agc_rope_map(); no instance may still use it
+void agc_rope_unmap(const agc_rope_t *rope);
+
+// 64-bit FNV-1a over the rope words; equal contents hash equally
+// whatever format they were loaded from
+uint64_t agc_rope_checksum(const agc_rope_t *rope);
+
+const char *agc_rope_format_name(agc_rope_format_t format);
+
+/*
+ * Shared image registry.
+ *
+ * agc_rope_acquire() returns a reference-counted, read-only rope for an
+ * image path. A path seen before (same file, unchanged since) costs one
+ * stat(); a new path is mapped once and, if its contents hash and compare
+ * equal to a resident image, folded into that image. Every instance that
+ * runs the same rope therefore shares one copy of its words, decoded
+ * table and info. The registry is safe to use from several threads.
+ */
+
+// Take a reference to the image at path; NULL if it cannot be loaded.
+// info, if given, receives the metadata of the resident image.
+const agc_rope_t *agc_rope_acquire(const char *path, agc_rope_info_t *info);
+
+// Drop a reference; the image is unmapped when the last one goes.
+// Instances attached to it must be re-attached first.
+void agc_rope_release(const agc_rope_t *rope);
+
+// Number of images currently resident in the registry
+size_t agc_rope_resident(void);
+
+#endif // AGC_ROPE_H
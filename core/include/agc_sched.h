@@ -0,0 +1,143 @@
+#ifndef AGC_SCHED_H
+#define AGC_SCHED_H
+
+#include "agc_types.h"
+#include "agc_cpu.h"
+
+/*
+ * Event scheduler.
+ *
+ * Events are keyed on cycle_count and kept in a binary min-heap, ordered
+ * by cycle and then by the order they were scheduled. The instance keeps
+ * the cycle of the earliest one in cpu->next_event, so every run loop and
+ * agc_cpu_step() check for due events with one compare per instruction
+ * boundary and call agc_sched_fire() only when it holds. With no scheduler
+ * attached next_event stays UINT64_MAX and the check never passes.
+ *
+ * An event fires at the first instruction boundary at which cycle_count
+ * has reached its cycle, before the stop conditions are checked, so a
+ * run stops on what the event did. Superblocks are not entered across an
+ * event and idle loops are skipped up to it, which keeps firing times
+ * identical on every interpreter core. Events scheduled at or before the
+ * current cycle from inside a handler fire at the next boundary.
+ *
+ * Peripherals schedule their own future events (a DSKY key repeat, an
+ * uplink word arriving) instead of polling on every step. Handlers run on
+ * the CPU thread, between instructions; peripherals on other threads go
+ * through agc_channels.h instead.
+ *
+ * agc_sched_timers() adds the Block II timers, driven by the 1.024 MHz
+ * clock (12 pulses per MCT) as in hardware:
+ *   - TIME1, TIME3, TIME4, TIME5 count up every 10 ms, TIME4 7.5 ms out
+ *     of phase with the others; TIME1 overflowing counts TIME2 up.
+ *   - TIME3, TIME4 and TIME5 overflowing request T3RUPT, T4RUPT, T5RUPT.
+ *   - TIME6 counts toward zero every 1/1600 s while bit 15 of channel 13
+ *     is set; a tick at zero requests T6RUPT and clears the bit. Writing
+ *     the bit through agc_io_write() starts it.
+ * Each counter increment steals one MCT, advancing cycle_count.
+ *
+ * Interrupt requests are latched in cpu->rupt_pending, one bit per
+ * AGC_RUPT_* number. This instruction subset cannot take or return from
+ * an interrupt, so servicing one is the host's job: agc_cpu_run() stops
+ * with AGC_STOP_RUPT while any request is pending and the host clears
+ * the bits it handled.
+ *
+ * The queue is not part of an agc_snapshot_t.
+ */
+
+#define AGC_SCHED_MAX 32            // Events pending at once
+
+// Clock pulses, in 1.024 MHz periods
+#define AGC_PULSES_PER_MCT 12
+#define AGC_PULSES_CS      10240    // 10 ms: TIME1, TIME3..TIME5
+#define AGC_PULSES_T4      7680     // TIME4 phase after TIME3
+#define AGC_PULSES_T6      640      // 1/1600 s: TIME6
+
+// Counter cells, in erasable bank 0
+#define AGC_TIME2 024
+#define AGC_TIME1 025
+#define AGC_TIME3 026
+#define AGC_TIME4 027
+#define AGC_TIME5 030
+#define AGC_TIME6 031
+
+#define AGC_CHAN_TIME6   013        // Channel holding the TIME6 enable
+#define AGC_TIME6_ENABLE 040000     // Bit 15 of channel 13
+
+// Interrupt numbers, highest priority first
+typedef enum {
+    AGC_RUPT_T6       = 1,
+    AGC_RUPT_T5       = 2,
+    AGC_RUPT_T3       = 3,
+    AGC_RUPT_T4       = 4,
+    AGC_RUPT_KEY1     = 5,
+    AGC_RUPT_KEY2     = 6,
+    AGC_RUPT_UPLINK   = 7,
+    AGC_RUPT_DOWNLINK = 8,
+    AGC_RUPT_RADAR    = 9,
+    AGC_RUPT_HAND     = 10,
+} agc_rupt_t;
+
+typedef void (*agc_event_fn)(agc_cpu_t *cpu, void *ctx);
+
+typedef struct {
+    uint64_t cycle;             // Fires once cycle_count reaches this
+    uint32_t id;                // Scheduling order, breaks ties
+    agc_event_fn fn;
+    void *ctx;
+} agc_event_t;
+
+typedef struct agc_sched {
+    agc_event_t heap[AGC_SCHED_MAX];
+    uint32_t count;
+    uint32_t next_id;
+    bool firing;                // Inside agc_sched_fire()
+    uint64_t fired;             // Events fired so far
+
+    // Timers, with phases in clock pulses since cycle 0
+    bool timers;                // Started by agc_sched_timers()
+    uint64_t cs_pulse;          // Next TIME1/3/5 increment
+    uint64_t t4_pulse;          // Next TIME4 increment
+    uint64_t t6_pulse;          // Next TIME6 tick
+    uint32_t cs_id, t4_id, t6_id;   // Their events, 0 when not scheduled
+} agc_sched_t;
+
+// Empty the queue and stop the timers
+void agc_sched_init(agc_sched_t *sched);
+
+// Fire events from sched (NULL detaches and leaves nothing scheduled)
+void agc_sched_attach(agc_cpu_t *cpu, agc_sched_t *sched);
+
+// Schedule fn(cpu, ctx) at an absolute cycle or delay MCTs from now.
+// Returns an id for agc_sched_cancel(), or 0 if no scheduler is attached
+// or the queue is full.
+uint32_t agc_sched_at(agc_cpu_t *cpu, uint64_t cycle, agc_event_fn fn, void *ctx);
+uint32_t agc_sched_after(agc_cpu_t *cpu, uint64_t delay, agc_event_fn fn, void *ctx);
+
+// Remove a pending event; false if it already fired or never existed
+bool agc_sched_cancel(agc_cpu_t *cpu, uint32_t id);
+
+// Start or stop the TIME1..TIME6 counters. Started timers keep the
+// hardware phase: the first increment lands on the next 10 ms tick of
+// the clock since cycle 0, not 10 ms from now.
+bool agc_sched_timers(agc_cpu_t *cpu, bool on);
+
+// Schedule TIME6 if the timers run and channel 13 enables it;
+// agc_io_write() calls this on writes to channel 13
+void agc_sched_time6(agc_cpu_t *cpu);
+
+// Fire every event due at cycle_count and update next_event
+void agc_sched_fire(agc_cpu_t *cpu);
+
+// Fire due events, if any; the per-boundary check of the run loops
+static inline void agc_sched_poll(agc_cpu_t *cpu) {
+    if (cpu->cycle_count >= cpu->next_event)
+        agc_sched_fire(cpu);
+}
+
+// Latch an interrupt request
+static inline void agc_rupt_request(agc_cpu_t *cpu, agc_rupt_t rupt) {
+    cpu->rupt_pending |= (uint16_t)(1u << rupt);
+}
+
+#endif // AGC_SCHED_H
@@ -0,0 +1,51 @@
+#ifndef AGC_SNAPSHOT_H
+#define AGC_SNAPSHOT_H
+
+#include "agc_types.h"
+#include "agc_cpu.h"
+
+/*
+ * Snapshots of a running instance.
+ *
+ * A snapshot captures everything an instance owns: registers, I/O
+ * channels, bank registers, emulated time and erasable memory. The rope
+ * is shared and read-only, so it is referenced rather than copied; restore
+ * into an instance that has the same rope attached.
+ *
+ * agc_snapshot_t is the binary blob itself: a fixed layout in host byte
+ * order, tagged with a magic number and a format version. Taking and
+ * restoring one is a few memcpys, cheap enough to branch thousands of
+ * runs from one checkpoint.
+ */
+
+#define AGC_SNAPSHOT_MAGIC   0x53434741u   // "AGCS"
+#define AGC_SNAPSHOT_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                  // sizeof(agc_snapshot_t) when taken
+
+    // Registers
+    agc_word_t A, L, Q, Z;
+    uint8_t EB, FB, BB;
+    uint8_t reserved;
+    agc_word_t current_instruction;
+    uint64_t cycle_count;
+
+    // I/O channels
+    agc_word_t IN[16];
+    agc_word_t OUT[16];
+
+    // Erasable memory
+    agc_word_t erasable[AGC_RAM_SIZE];
+} agc_snapshot_t;
+
+// Capture the instance state into snap
+void agc_snapshot_take(const agc_cpu_t *cpu, agc_snapshot_t *snap);
+
+// Restore a snapshot; returns false (and leaves cpu untouched) if the
+// blob has the wrong magic, version or size
+bool agc_snapshot_restore(agc_cpu_t *cpu, const agc_snapshot_t *snap);
+
+#endif // AGC_SNAPSHOT_H
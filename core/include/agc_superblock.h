@@ -0,0 +1,55 @@
+#ifndef AGC_SUPERBLOCK_H
+#define AGC_SUPERBLOCK_H
+
+#include "agc_types.h"
+
+/*
+ * Superblock tier (built with AGC_SUPERBLOCKS).
+ *
+ * Straight-line runs of fixed-memory code that execute often are compiled
+ * into superblocks: a chain of pre-bound handler calls whose operands are
+ * already resolved to erasable words for the current EB. Entering a block
+ * costs one Z/bank check instead of a fetch, decode and dispatch per
+ * instruction. A block is dropped as soon as EB, FB, the rope or the
+ * rope's generation (bumped by every load and agc_rom_set()) differ from
+ * what it was compiled for.
+ */
+
+#define AGC_SB_SLOTS      64    // Direct-mapped block cache entries
+#define AGC_SB_MAX_OPS    16    // Longest block
+#define AGC_SB_HOT        16    // Visits before a start address is compiled
+
+struct agc_cpu;
+struct agc_rope;
+struct agc_sb_op;
+
+typedef void (*agc_sb_fn)(struct agc_cpu *cpu, const struct agc_sb_op *op);
+
+// One pre-bound instruction
+typedef struct agc_sb_op {
+    agc_sb_fn fn;
+    agc_word_t *operand;        // Erasable word, resolved for the block's EB
+    agc_word_t target;          // TC target
+} agc_sb_op_t;
+
+typedef struct {
+    agc_word_t start;           // Z of the first instruction
+    uint16_t bank_key;          // EB | FB << 8 the block was compiled for
+    const struct agc_rope *rope;
+    uint32_t rope_gen;          // rope->generation the block was compiled from
+    uint8_t len;                // Instructions in the block, 0 = empty slot
+    uint8_t heat;               // Visits to start while not compiled
+    bool ends_in_tc;            // Last op sets Z itself
+    agc_word_t last_word;       // current_instruction after the block
+    uint32_t mct;               // Total duration of the block
+    agc_sb_op_t ops[AGC_SB_MAX_OPS];
+} agc_superblock_t;
+
+// Run the block starting at Z if one is cached and fits in budget.
+// Returns the number of instructions executed (0 if none).
+uint64_t agc_sb_run(struct agc_cpu *cpu, uint64_t budget);
+
+// Drop every cached block
+void agc_sb_flush(struct agc_cpu *cpu);
+
+#endif // AGC_SUPERBLOCK_H
@@ -0,0 +1,56 @@
+#ifndef AGC_TIMING_H
+#define AGC_TIMING_H
+
+#include <time.h>
+#include "agc_types.h"
+#include "agc_cpu.h"
+
+/*
+ * Emulated time.
+ *
+ * cycle_count counts memory cycle times (MCT). The Block II clock runs at
+ * 1.024 MHz and one MCT is 12 clock pulses, i.e. 11.71875 us exactly.
+ */
+
+#define AGC_MCT_PS        11718750ULL   // One MCT in picoseconds
+#define AGC_MCT_PER_SEC   (1024000.0 / 12.0)
+#define AGC_MCT_PER_3S    256000ULL     // Exactly 3 seconds
+
+// Convert MCTs to nanoseconds of emulated time. Whole 3 s periods are
+// converted apart from the rest, so the product cannot overflow.
+static inline uint64_t agc_mct_to_ns(uint64_t mct) {
+    return mct / AGC_MCT_PER_3S * 3000000000ULL +
+           mct % AGC_MCT_PER_3S * AGC_MCT_PS / 1000;
+}
+
+/*
+ * Wall-clock pacing.
+ *
+ * Holds the emulation to rate x real time. Every slice_mct of emulated
+ * time the pacer compares emulated time against the wall clock since
+ * agc_pacer_start() and sleeps until the two agree. Targets are absolute,
+ * so sleep overshoot and slow slices are corrected on the next slice
+ * instead of accumulating as drift.
+ *
+ * A slice spans at least 1 ms of wall time at the pacer's rate, so the
+ * clock is read at most about once a millisecond however fast the rate.
+ * agc_bench's tc_loop_paced scenario measures what pacing costs.
+ */
+typedef struct {
+    struct timespec start;      // Wall clock at agc_pacer_start()
+    uint64_t start_mct;         // cycle_count at agc_pacer_start()
+    uint64_t slice_mct;         // Emulated time between clock checks, >= 1 ms / rate
+    double rate;                // 1.0 = real time
+} agc_pacer_t;
+
+// Slice at rate 1.0: just over 1 ms of emulated time
+#define AGC_PACER_SLICE_MCT 86
+
+void agc_pacer_start(agc_pacer_t *pacer, const agc_cpu_t *cpu, double rate);
+
+// agc_cpu_run() held to the pacer's rate
+agc_stop_reason_t agc_cpu_run_paced(agc_cpu_t *cpu, agc_pacer_t *pacer,
+                                    uint64_t max_instructions, uint32_t stop_mask,
+                                    uint64_t *executed);
+
+#endif // AGC_TIMING_H
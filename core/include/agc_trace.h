@@ -0,0 +1,88 @@
+#ifndef AGC_TRACE_H
+#define AGC_TRACE_H
+
+#include <stddef.h>
+#include "agc_types.h"
+#include "agc_cpu.h"
+#include "agc_memory.h"
+
+/*
+ * Binary instruction trace.
+ *
+ * An instance with a trace attached writes one fixed-size record per
+ * instruction into a preallocated ring, overwriting the oldest once it
+ * is full, so the last capacity instructions are always at hand and
+ * recording never allocates or formats. While a trace is attached,
+ * agc_cpu_run() and agc_cpu_exec() step one instruction at a time (no
+ * idle skip, no superblocks) so every instruction is recorded.
+ *
+ * agc_trace_dump() writes the ring, oldest record first, after an
+ * agc_trace_header_t, in host byte order. agc_trace_dump_fd() does the
+ * same with write(2) alone, for use from a fault signal handler.
+ * tools/agc_trace.c decodes a dump into text.
+ */
+
+#define AGC_TRACE_MAGIC   0x54434741u   // "AGCT"
+#define AGC_TRACE_VERSION 1
+
+// One instruction, as it was about to execute
+typedef struct {
+    uint64_t cycle;             // cycle_count before it
+    agc_word_t z;               // Address it was fetched from
+    agc_word_t instr;           // Instruction word
+    agc_word_t a;               // A before it
+    uint8_t eb, fb;
+} agc_trace_rec_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;       // sizeof(agc_trace_rec_t)
+    uint64_t count;             // Records that follow
+    uint64_t dropped;           // Older records overwritten in the ring
+} agc_trace_header_t;
+
+typedef struct agc_trace {
+    agc_trace_rec_t *records;
+    uint64_t mask;              // Capacity - 1 (capacity is a power of two)
+    uint64_t written;           // Records ever written; the newest is at (written - 1) & mask
+} agc_trace_t;
+
+static inline void agc_trace_record(agc_trace_t *trace, agc_cpu_t *cpu) {
+    agc_memory_sync_banks(cpu);
+    agc_trace_rec_t *r = &trace->records[trace->written++ & trace->mask];
+    r->cycle = cpu->cycle_count;
+    r->z = cpu->Z;
+    r->instr = agc_memory_read_banked(cpu, cpu->Z);
+    r->a = cpu->A;
+    r->eb = cpu->EB;
+    r->fb = cpu->FB;
+}
+
+// Allocate a ring of at least capacity records (rounded up to a power
+// of two). Returns false if out of memory or if the ring would not fit
+// in a size_t.
+bool agc_trace_init(agc_trace_t *trace, size_t capacity);
+void agc_trace_free(agc_trace_t *trace);
+
+// Forget every record
+void agc_trace_reset(agc_trace_t *trace);
+
+// Start recording into trace (NULL stops)
+void agc_trace_attach(agc_cpu_t *cpu, agc_trace_t *trace);
+
+// Records currently held, and the i-th of them counting from the oldest
+size_t agc_trace_count(const agc_trace_t *trace);
+const agc_trace_rec_t *agc_trace_at(const agc_trace_t *trace, size_t i);
+
+// Write the ring to a file or an open descriptor
+bool agc_trace_dump(const agc_trace_t *trace, const char *path);
+bool agc_trace_dump_fd(const agc_trace_t *trace, int fd);
+
+// Read a dump; *records is malloc'ed and holds header->count records
+bool agc_trace_load(const char *path, agc_trace_header_t *header, agc_trace_rec_t **records);
+
+// One record as a line of text (no newline), disassembled
+void agc_trace_format(const agc_trace_rec_t *rec, char *buf, size_t size);
+
+#endif // AGC_TRACE_H
@@ -0,0 +1,58 @@
+#ifndef AGC_WORDS_H
+#define AGC_WORDS_H
+
+#include <stddef.h>
+#include "agc_types.h"
+
+// Signed value of a word: -16383..16383, both zeros give 0
+static inline int32_t agc_word_value(agc_word_t w) {
+    return agc_is_negative(w) ? -(int32_t)agc_negate(w) : (int32_t)w;
+}
+
+// Signed value of a double-precision pair (high word, low word)
+static inline int32_t agc_dp_value(agc_word_t hi, agc_word_t lo) {
+    return agc_word_value(hi) * 16384 + agc_word_value(lo);
+}
+
+/*
+ * Bulk kernels over arrays of 15-bit words.
+ *
+ * The _scalar versions are the reference: one call of the single-word
+ * helper per element. The plain versions (agc_words.c) compute the same
+ * results with AVX2, SSE2 or NEON, whichever the library is compiled
+ * for, and finish the tail with the reference. Inputs must be normalized
+ * (bit 15 clear); dst may alias an input.
+ */
+
+static inline void agc_add_n_scalar(agc_word_t *dst, const agc_word_t *a, const agc_word_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        dst[i] = agc_add(a[i], b[i]);
+}
+
+static inline void agc_negate_n_scalar(agc_word_t *dst, const agc_word_t *a, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        dst[i] = agc_negate(a[i]);
+}
+
+// neg[i] = 1 for negative words; returns how many there were
+static inline size_t agc_sign_n_scalar(uint8_t *neg, const agc_word_t *a, size_t n) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        neg[i] = agc_is_negative(a[i]);
+        count += neg[i];
+    }
+    return count;
+}
+
+// dst[i] = value of the pair (hi[i], lo[i])
+static inline void agc_dp_n_scalar(int32_t *dst, const agc_word_t *hi, const agc_word_t *lo, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        dst[i] = agc_dp_value(hi[i], lo[i]);
+}
+
+void agc_add_n(agc_word_t *dst, const agc_word_t *a, const agc_word_t *b, size_t n);
+void agc_negate_n(agc_word_t *dst, const agc_word_t *a, size_t n);
+size_t agc_sign_n(uint8_t *neg, const agc_word_t *a, size_t n);
+void agc_dp_n(int32_t *dst, const agc_word_t *hi, const agc_word_t *lo, size_t n);
+
+#endif // AGC_WORDS_H
@@ -0,0 +1,236 @@
+#define _POSIX_C_SOURCE 200809L    // sysconf
+
+#include "agc_campaign.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Results buffered per worker before taking the stream lock
+#define RESULT_BATCH 256
+
+// One worker's remaining run indices [lo, hi); own cache line each
+typedef struct {
+    _Alignas(64) pthread_mutex_t lock;
+    size_t lo, hi;
+} run_slice_t;
+
+typedef struct {
+    const agc_campaign_t *c;
+    run_slice_t *slices;
+    unsigned workers;
+    pthread_mutex_t out_lock;
+    bool out_failed;
+} pool_t;
+
+typedef struct {
+    pool_t *pool;
+    unsigned id;
+} worker_arg_t;
+
+void agc_perturb_apply(agc_cpu_t *cpu, const agc_perturbation_t *p) {
+    switch (p->kind) {
+        case AGC_PERTURB_ERASABLE: {
+            int eb = p->bank % (AGC_RAM_SIZE / AGC_ERASE_BANK_SIZE);
+            cpu->erasable[eb * AGC_ERASE_BANK_SIZE + (p->addr & 01777)] = agc_normalize(p->value);
+            agc_memory_mark(cpu, (uint32_t)(eb * AGC_ERASE_BANK_SIZE + (p->addr & 01777)));
+            break;
+        }
+        case AGC_PERTURB_IN:
+            cpu->IN[p->addr & 15] = agc_normalize(p->value);
+            break;
+        case AGC_PERTURB_REG:
+            switch (p->addr) {
+                case AGC_REG_A:  cpu->A = agc_normalize(p->value); break;
+                case AGC_REG_L:  cpu->L = agc_normalize(p->value); break;
+                case AGC_REG_Q:  cpu->Q = agc_normalize(p->value); break;
+                case AGC_REG_Z:  cpu->Z = agc_normalize(p->value); break;
+                case AGC_REG_EB: cpu->EB = (uint8_t)p->value; break;
+                case AGC_REG_FB: cpu->FB = (uint8_t)p->value; break;
+                default: break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Take the next run: own slice first, then the back half of another's
+static bool take_run(pool_t *pool, unsigned id, size_t *run) {
+    run_slice_t *own = &pool->slices[id];
+
+    pthread_mutex_lock(&own->lock);
+    bool found = own->lo < own->hi;
+    if (found) *run = own->lo++;
+    pthread_mutex_unlock(&own->lock);
+    if (found) return true;
+
+    for (unsigned k = 1; k < pool->workers; k++) {
+        run_slice_t *victim = &pool->slices[(id + k) % pool->workers];
+        size_t lo = 0, hi = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->hi > victim->lo) {
+            lo = victim->lo + (victim->hi - victim->lo) / 2;
+            hi = victim->hi;
+            victim->hi = lo;
+        }
+        pthread_mutex_unlock(&victim->lock);
+        if (lo == hi) continue;
+
+        // The stolen range is in no slice until here, so nobody else can
+        // run it; an idle worker may see every slice empty and leave early
+        pthread_mutex_lock(&own->lock);
+        own->lo = lo + 1;
+        own->hi = hi;
+        pthread_mutex_unlock(&own->lock);
+        *run = lo;
+        return true;
+    }
+    return false;
+}
+
+static uint64_t erasable_hash(const agc_cpu_t *cpu) {
+    uint64_t h = 14695981039346656037ULL;
+    for (int i = 0; i < AGC_RAM_SIZE; i++) {
+        h = (h ^ (cpu->erasable[i] & 0xff)) * 1099511628211ULL;
+        h = (h ^ (cpu->erasable[i] >> 8)) * 1099511628211ULL;
+    }
+    return h;
+}
+
+static void flush_results(pool_t *pool, const agc_campaign_result_t *buf, size_t n) {
+    if (n == 0) return;
+    pthread_mutex_lock(&pool->out_lock);
+    if (fwrite(buf, sizeof(*buf), n, pool->c->out) != n)
+        pool->out_failed = true;
+    pthread_mutex_unlock(&pool->out_lock);
+}
+
+static void *worker_main(void *p) {
+    worker_arg_t *arg = p;
+    pool_t *pool = arg->pool;
+    const agc_campaign_t *c = pool->c;
+    const agc_run_set_t *runs = &c->runs;
+
+    agc_cpu_t *cpu = malloc(sizeof(*cpu));
+    agc_campaign_result_t *buf = c->out ? malloc(RESULT_BATCH * sizeof(*buf)) : NULL;
+    if (!cpu || (c->out && !buf)) {
+        // Leave the work to the other workers
+        free(cpu);
+        free(buf);
+        return NULL;
+    }
+    agc_cpu_reset(cpu);
+    agc_memory_attach_rope(cpu, c->rope);
+
+    size_t buffered = 0, run;
+    while (take_run(pool, arg->id, &run)) {
+        agc_snapshot_restore(cpu, c->base);
+        for (size_t i = runs->first[run]; i < runs->first[run + 1]; i++)
+            agc_perturb_apply(cpu, &runs->perturbations[i]);
+
+        uint64_t executed = 0;
+        agc_stop_reason_t stop = agc_cpu_run(cpu, c->max_instructions, c->stop_mask, &executed);
+
+        agc_campaign_result_t r = {
+            .run = (uint32_t)run,
+            .stop = (uint8_t)stop,
+            .EB = cpu->EB,
+            .FB = cpu->FB,
+            .executed = executed,
+            .cycle_count = cpu->cycle_count,
+            .A = cpu->A, .L = cpu->L, .Q = cpu->Q, .Z = cpu->Z,
+            .erasable_hash = erasable_hash(cpu),
+        };
+        memcpy(r.OUT, cpu->OUT, sizeof(r.OUT));
+
+        if (c->results)
+            c->results[run] = r;
+        if (buf) {
+            buf[buffered++] = r;
+            if (buffered == RESULT_BATCH) {
+                flush_results(pool, buf, buffered);
+                buffered = 0;
+            }
+        }
+    }
+    if (buf)
+        flush_results(pool, buf, buffered);
+
+    free(cpu);
+    free(buf);
+    return NULL;
+}
+
+bool agc_campaign_run(const agc_campaign_t *c) {
+    if (c->base->magic != AGC_SNAPSHOT_MAGIC ||
+        c->base->version != AGC_SNAPSHOT_VERSION ||
+        c->base->size != sizeof(agc_snapshot_t))
+        return false;
+
+    size_t n = c->runs.run_count;
+    if (c->out) {
+        agc_campaign_header_t h = {
+            .magic = AGC_CAMPAIGN_MAGIC,
+            .version = AGC_CAMPAIGN_VERSION,
+            .record_size = (uint16_t)sizeof(agc_campaign_result_t),
+            .run_count = n,
+        };
+        if (fwrite(&h, sizeof(h), 1, c->out) != 1)
+            return false;
+    }
+
+    unsigned workers = c->threads;
+    if (workers == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = online > 0 ? (unsigned)online : 1;
+    }
+    if (workers > n) workers = n ? (unsigned)n : 1;
+
+    pool_t pool = { .c = c, .workers = workers };
+    pool.slices = aligned_alloc(64, workers * sizeof(run_slice_t));
+    worker_arg_t *args = malloc(workers * sizeof(*args));
+    pthread_t *threads = malloc(workers * sizeof(*threads));
+    if (!pool.slices || !args || !threads) {
+        free(pool.slices);
+        free(args);
+        free(threads);
+        return false;
+    }
+    pthread_mutex_init(&pool.out_lock, NULL);
+    for (unsigned i = 0; i < workers; i++) {
+        pthread_mutex_init(&pool.slices[i].lock, NULL);
+        pool.slices[i].lo = n * i / workers;
+        pool.slices[i].hi = n * (i + 1) / workers;
+        args[i] = (worker_arg_t){ &pool, i };
+    }
+
+    // Worker 0 runs on the calling thread
+    unsigned started = 1;
+    for (unsigned i = 1; i < workers; i++, started++)
+        if (pthread_create(&threads[i], NULL, worker_main, &args[i]) != 0)
+            break;
+    worker_main(&args[0]);
+    for (unsigned i = 1; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    // A worker that could not start leaves its slice to the others, but
+    // an allocation failure in every worker leaves runs undone
+    bool ok = true;
+    for (unsigned i = 0; i < workers; i++) {
+        if (pool.slices[i].lo < pool.slices[i].hi)
+            ok = false;
+        pthread_mutex_destroy(&pool.slices[i].lock);
+    }
+    pthread_mutex_destroy(&pool.out_lock);
+
+    if (c->out && (pool.out_failed || fflush(c->out) != 0))
+        ok = false;
+
+    free(pool.slices);
+    free(args);
+    free(threads);
+    return ok;
+}
@@ -0,0 +1,63 @@
+#include "agc_channels.h"
+#include "agc_journal.h"
+
+#include <string.h>
+
+void agc_chan_init(agc_channels_t *chan) {
+    memset(chan, 0, sizeof(*chan));
+}
+
+void agc_chan_attach(agc_cpu_t *cpu, agc_channels_t *chan) {
+    cpu->channels = chan;
+}
+
+void agc_chan_journal(agc_channels_t *chan, agc_journal_t *j) {
+    chan->journal = j;
+}
+
+/*
+ * The pending bit is set after the value is queued, and the CPU clears
+ * the mask before it drains, so a value is either drained now or still
+ * flagged for the next drain.
+ */
+bool agc_chan_send(agc_channels_t *chan, uint8_t channel, agc_word_t value) {
+    channel &= 15;
+    if (!agc_spsc_push(&chan->in[channel], agc_normalize(value)))
+        return false;
+    atomic_fetch_or_explicit(&chan->in_pending, 1u << channel, memory_order_release);
+    return true;
+}
+
+bool agc_chan_recv(agc_channels_t *chan, uint8_t channel, agc_word_t *value) {
+    return agc_spsc_pop(&chan->out[channel & 15], value);
+}
+
+size_t agc_chan_drain(agc_cpu_t *cpu) {
+    agc_channels_t *chan = cpu->channels;
+    if (!chan || !atomic_load_explicit(&chan->in_pending, memory_order_relaxed))
+        return 0;
+
+    uint32_t pending = atomic_exchange_explicit(&chan->in_pending, 0, memory_order_acquire);
+    size_t n = 0;
+    while (pending) {
+        int ch = __builtin_ctz(pending);
+        pending &= pending - 1;
+
+        // At most one queue's worth, so a fast producer cannot hold the
+        // CPU here; anything left stays flagged
+        agc_word_t value;
+        int got = 0;
+        while (got < AGC_CHAN_QUEUE && agc_spsc_pop(&chan->in[ch], &value)) {
+            if (chan->journal)
+                agc_journal_input(chan->journal, cpu, AGC_JOURNAL_IN, (agc_word_t)ch, value);
+            else
+                cpu->IN[ch] = value;
+            got++;
+        }
+        if (got == AGC_CHAN_QUEUE)
+            atomic_fetch_or_explicit(&chan->in_pending, 1u << ch, memory_order_relaxed);
+        chan->in_count[ch] += (uint64_t)got;
+        n += (size_t)got;
+    }
+    return n;
+}
@@ -0,0 +1,107 @@
+#include "agc_checkpoint.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ALL_PAGES UINT64_MAX
+
+void agc_ckpt_init(agc_ckpt_log_t *log) {
+    memset(log, 0, sizeof(*log));
+}
+
+void agc_ckpt_free(agc_ckpt_log_t *log) {
+    free(log->ckpts);
+    free(log->data);
+    agc_ckpt_init(log);
+}
+
+void agc_ckpt_reset(agc_ckpt_log_t *log) {
+    log->count = 0;
+    log->data_used = 0;
+}
+
+// Make room for n more items of size bytes, doubling the capacity
+static bool reserve(void **buf, size_t *capacity, size_t used, size_t n, size_t size) {
+    if (used + n <= *capacity) return true;
+    size_t cap = *capacity ? *capacity : 64;
+    while (cap < used + n) cap *= 2;
+    void *grown = realloc(*buf, cap * size);
+    if (!grown) return false;
+    *buf = grown;
+    *capacity = cap;
+    return true;
+}
+
+bool agc_ckpt_take(agc_ckpt_log_t *log, agc_cpu_t *cpu) {
+    uint64_t pages = log->count ? cpu->dirty : ALL_PAGES;
+    size_t words = (size_t)__builtin_popcountll(pages) * AGC_DIRTY_WORDS;
+    if (!reserve((void **)&log->ckpts, &log->capacity, log->count, 1, sizeof(agc_ckpt_t)) ||
+        !reserve((void **)&log->data, &log->data_capacity, log->data_used, words, sizeof(agc_word_t)))
+        return false;
+
+    agc_ckpt_t *c = &log->ckpts[log->count++];
+    c->A = cpu->A;
+    c->L = cpu->L;
+    c->Q = cpu->Q;
+    c->Z = cpu->Z;
+    c->EB = cpu->EB;
+    c->FB = cpu->FB;
+    c->BB = cpu->BB;
+    c->current_instruction = cpu->current_instruction;
+    c->cycle_count = cpu->cycle_count;
+    memcpy(c->IN, cpu->IN, sizeof(c->IN));
+    memcpy(c->OUT, cpu->OUT, sizeof(c->OUT));
+    c->pages = pages;
+    c->data = log->data_used;
+
+    agc_word_t *dst = &log->data[log->data_used];
+    for (uint64_t left = pages; left; left &= left - 1) {
+        int page = __builtin_ctzll(left);
+        memcpy(dst, &cpu->erasable[page * AGC_DIRTY_WORDS], AGC_DIRTY_WORDS * sizeof(agc_word_t));
+        dst += AGC_DIRTY_WORDS;
+    }
+    log->data_used += words;
+    cpu->dirty = 0;
+    return true;
+}
+
+size_t agc_ckpt_words(const agc_ckpt_log_t *log, size_t i) {
+    return i < log->count ? (size_t)__builtin_popcountll(log->ckpts[i].pages) * AGC_DIRTY_WORDS : 0;
+}
+
+bool agc_ckpt_rebuild(const agc_ckpt_log_t *log, size_t i, agc_snapshot_t *snap) {
+    if (i >= log->count) return false;
+
+    // Newest first: a page is final once some checkpoint has supplied it,
+    // and the base supplies whatever is left
+    uint64_t missing = ALL_PAGES;
+    for (size_t k = i + 1; k-- > 0 && missing; ) {
+        const agc_ckpt_t *c = &log->ckpts[k];
+        const agc_word_t *src = &log->data[c->data];
+        for (uint64_t left = c->pages; left; left &= left - 1) {
+            int page = __builtin_ctzll(left);
+            if ((missing >> page) & 1)
+                memcpy(&snap->erasable[page * AGC_DIRTY_WORDS], src, AGC_DIRTY_WORDS * sizeof(agc_word_t));
+            src += AGC_DIRTY_WORDS;
+        }
+        missing &= ~c->pages;
+    }
+
+    const agc_ckpt_t *c = &log->ckpts[i];
+    snap->magic = AGC_SNAPSHOT_MAGIC;
+    snap->version = AGC_SNAPSHOT_VERSION;
+    snap->size = (uint16_t)sizeof(agc_snapshot_t);
+    snap->A = c->A;
+    snap->L = c->L;
+    snap->Q = c->Q;
+    snap->Z = c->Z;
+    snap->EB = c->EB;
+    snap->FB = c->FB;
+    snap->BB = c->BB;
+    snap->reserved = 0;
+    snap->current_instruction = c->current_instruction;
+    snap->cycle_count = c->cycle_count;
+    memcpy(snap->IN, c->IN, sizeof(snap->IN));
+    memcpy(snap->OUT, c->OUT, sizeof(snap->OUT));
+    return true;
+}
@@ -0,0 +1,93 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "agc_corefile.h"
+#include "agc_memory.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define COREFILE_SIZE (AGC_COREFILE_OFFSET + AGC_RAM_BYTES)
+
+bool agc_corefile_open(agc_corefile_t *file, const char *path) {
+    memset(file, 0, sizeof(*file));
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    // An empty file is new (ftruncate zero-fills); anything else must fit
+    file->created = st.st_size == 0;
+    if ((file->created && ftruncate(fd, COREFILE_SIZE) != 0) ||
+        (!file->created && st.st_size != COREFILE_SIZE)) {
+        close(fd);
+        return false;
+    }
+
+    // The mapping outlives the descriptor
+    void *base = mmap(NULL, COREFILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+
+    agc_corefile_header_t *h = base;
+    if (file->created) {
+        h->magic = AGC_COREFILE_MAGIC;
+        h->version = AGC_COREFILE_VERSION;
+        h->word_size = (uint16_t)sizeof(agc_word_t);
+        h->words = AGC_RAM_SIZE;
+    } else if (h->magic != AGC_COREFILE_MAGIC || h->version != AGC_COREFILE_VERSION ||
+               h->word_size != sizeof(agc_word_t) || h->words != AGC_RAM_SIZE) {
+        munmap(base, COREFILE_SIZE);
+        return false;
+    }
+
+    file->base = base;
+    file->size = COREFILE_SIZE;
+    file->words = (agc_word_t *)((char *)base + AGC_COREFILE_OFFSET);
+    return true;
+}
+
+void agc_corefile_close(agc_corefile_t *file) {
+    if (!file->base) return;
+    // A reset may already have taken the instance off the file
+    if (file->cpu && file->cpu->corefile == file)
+        agc_corefile_attach(file->cpu, NULL);
+    munmap(file->base, file->size);
+    memset(file, 0, sizeof(*file));
+}
+
+void agc_corefile_attach(agc_cpu_t *cpu, agc_corefile_t *file) {
+    // Leaving a file: keep what it held
+    if (cpu->corefile) {
+        memcpy(cpu->erasable_store, cpu->erasable, AGC_RAM_BYTES);
+        cpu->erasable = cpu->erasable_store;
+        cpu->corefile->cpu = NULL;
+        cpu->corefile = NULL;
+    }
+
+    if (file) {
+        if (file->cpu && file->cpu->corefile == file)
+            agc_corefile_attach(file->cpu, NULL);
+        file->cpu = cpu;
+        cpu->corefile = file;
+        cpu->erasable = file->words;
+    }
+
+    // Every word may differ from the last checkpoint, and the bank cache
+    // and compiled blocks point into the old storage
+    cpu->dirty = UINT64_MAX;
+    agc_memory_rebank(cpu);
+#ifdef AGC_SUPERBLOCKS
+    agc_sb_flush(cpu);
+#endif
+}
+
+bool agc_corefile_sync(agc_corefile_t *file) {
+    return file->base && msync(file->base, file->size, MS_SYNC) == 0;
+}
@@ -1,6 +1,11 @@
 #include "agc_cpu.h"
 #include "agc_memory.h"
 #include "agc_instructions.h"
+#include "agc_profiler.h"
+#include "agc_debug.h"
+#include "agc_trace.h"
+#include "agc_channels.h"
+#include "agc_sched.h"
 
 #include <string.h> // memset
 
@@ -33,29 +38,127 @@ void agc_cpu_reset(agc_cpu_t *cpu) {
     // Internal CPU state
     cpu->current_instruction = 0;
     cpu->cycle_count = 0;
+
+    // No stop conditions armed
+    cpu->breakpoint_count = 0;
+    cpu->stop_z_lo = 1;
+    cpu->stop_z_hi = 0;
+    cpu->stop_cycle = UINT64_MAX;
+    cpu->out_written = 0;
+    cpu->debug = NULL;
+    cpu->debug_armed = 0;
+    cpu->debug_hit = 0;
+    cpu->debug_hit_phys = 0;
+    cpu->trace = NULL;
+    cpu->channels = NULL;
+
+    // Idle loops may be skipped; nothing is scheduled yet
+    cpu->idle_skip = true;
+    cpu->sched = NULL;
+    cpu->next_event = UINT64_MAX;
+    cpu->rupt_pending = 0;
+
+#ifdef AGC_SUPERBLOCKS
+    agc_sb_flush(cpu);
+#endif
+
+#ifdef AGC_PROFILER
+    cpu->prof = NULL;
+#endif
+
+    // Fresh memory context: own cleared erasable, default rope
+    memset(cpu->erasable_store, 0, sizeof(cpu->erasable_store));
+    cpu->erasable = cpu->erasable_store;
+    cpu->corefile = NULL;
+    cpu->dirty = UINT64_MAX;
+    agc_memory_attach_rope(cpu, NULL);
 }
 
 /*
  * Execute a single AGC instruction.
  * This is the core of the emulator: fetch → decode → execute.
  *
- * The AGC is not pipelined. Each instruction is executed sequentially.
- * Timing will be added later for cycle-accurate behavior.
+ * The AGC is not pipelined. Each instruction is executed sequentially
+ * and advances cycle_count by its duration in MCTs (agc_instr_mct).
+ * Scheduled events due before or after it fire at those boundaries.
  */
 void agc_cpu_step(agc_cpu_t *cpu) {
     if (!cpu) return;
 
+#ifdef AGC_THREADED_DISPATCH
+    agc_cpu_exec(cpu, 1);
+#else
+    agc_sched_poll(cpu);
+    AGC_PROF_RECORD(cpu);
+    if (cpu->trace)
+        agc_trace_record(cpu->trace, cpu);
+    if (cpu->debug_armed)
+        agc_debug_step(cpu);
+    else
+        agc_cpu_step_switch(cpu);
+    agc_sched_poll(cpu);
+#endif
+}
+
+void agc_cpu_step_switch(agc_cpu_t *cpu) {
     // Fetch instruction from memory at address Z
-    agc_word_t instr = agc_memory_read(cpu, cpu->Z);
+    agc_memory_sync_banks(cpu);
+
+    const agc_decoded_t *page = cpu->decoded_page[(cpu->Z >> 10) & 037];
+    if (page) {
+        // Fixed memory: use the decoded side-table built at ROM load
+        const agc_decoded_t *d = &page[cpu->Z & 01777];
+        cpu->current_instruction = d->word;
+        cpu->Z = agc_normalize(cpu->Z + 1);
+        agc_instr_table[d->handler](cpu, d->address);
+        cpu->cycle_count += agc_instr_mct[d->handler];
+    } else {
+        // Erasable memory: fetch and decode live
+        agc_word_t instr = agc_memory_read_banked(cpu, cpu->Z);
+
+        cpu->current_instruction = instr;
 
-    cpu->current_instruction = instr;
+        // Increment program counter (AGC increments Z before execution)
+        cpu->Z = agc_normalize(cpu->Z + 1);
+
+        // Decode and execute the instruction
+        agc_execute_instruction(cpu, instr);
+        cpu->cycle_count += agc_instr_mct[agc_get_opcode(instr)];
+    }
+}
 
-    // Increment program counter (AGC increments Z before execution)
-    cpu->Z = agc_normalize(cpu->Z + 1);
+/*
+ * Stop condition setup for agc_cpu_run().
+ */
+bool agc_cpu_add_breakpoint(agc_cpu_t *cpu, agc_word_t address) {
+    if (cpu->breakpoint_count >= AGC_MAX_BREAKPOINTS) return false;
+    cpu->breakpoints[cpu->breakpoint_count++] = agc_normalize(address);
+    return true;
+}
+
+void agc_cpu_clear_breakpoints(agc_cpu_t *cpu) {
+    cpu->breakpoint_count = 0;
+}
+
+void agc_cpu_set_stop_range(agc_cpu_t *cpu, agc_word_t lo, agc_word_t hi) {
+    cpu->stop_z_lo = agc_normalize(lo);
+    cpu->stop_z_hi = agc_normalize(hi);
+}
+
+/*
+ * Write an output channel.
+ * Peripherals and channel instructions go through here so that
+ * agc_cpu_run() can stop on I/O activity.
+ */
+void agc_io_write(agc_cpu_t *cpu, uint8_t channel, agc_word_t value) {
+    channel &= 15;
+    cpu->OUT[channel] = agc_normalize(value);
+    cpu->out_written |= (uint16_t)(1u << channel);
 
-    // Decode and execute the instruction
-    agc_execute_instruction(cpu, instr);
+    agc_channels_t *chan = cpu->channels;
+    if (chan && !agc_spsc_push(&chan->out[channel], cpu->OUT[channel]))
+        atomic_fetch_add_explicit(&chan->out_dropped[channel], 1, memory_order_relaxed);
 
-    // Increase cycle counter (placeholder for real timing)
-    cpu->cycle_count++;
+    if (channel == AGC_CHAN_TIME6)
+        agc_sched_time6(cpu);
 }
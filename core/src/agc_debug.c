@@ -1 +1,106 @@
-/* agc_debug.c - Debug helpers (placeholder) */
+/* agc_debug.c - Breakpoints and watchpoints */
+#include "agc_debug.h"
+#include "agc_instructions.h"
+
+#include <string.h>
+
+// Map index of a single AGC_DEBUG_* kind
+static int kind_bit(unsigned kind) {
+    return kind == AGC_DEBUG_EXEC ? 0 : kind == AGC_DEBUG_READ ? 1 : 2;
+}
+
+static void refresh_armed(agc_cpu_t *cpu) {
+    cpu->debug_armed = 0;
+    if (!cpu->debug) return;
+    for (int k = 0; k < AGC_DEBUG_KINDS; k++)
+        if (cpu->debug->count[k])
+            cpu->debug_armed |= (uint8_t)(1u << k);
+}
+
+void agc_debug_init(agc_debug_t *dbg) {
+    memset(dbg, 0, sizeof(*dbg));
+}
+
+void agc_debug_attach(agc_cpu_t *cpu, agc_debug_t *dbg) {
+    cpu->debug = dbg;
+    cpu->debug_hit = 0;
+    refresh_armed(cpu);
+}
+
+bool agc_debug_set(agc_cpu_t *cpu, unsigned kinds, uint8_t bank, agc_word_t addr, bool on) {
+    agc_debug_t *dbg = cpu->debug;
+    if (!dbg) return false;
+
+    uint32_t phys = agc_phys_index(bank, bank, addr);
+    uint64_t bit = (uint64_t)1 << (phys & 63);
+    for (int k = 0; k < AGC_DEBUG_KINDS; k++) {
+        if (!(kinds & (1u << k))) continue;
+        uint64_t *word = &dbg->map[k][phys >> 6];
+        if (on && !(*word & bit)) {
+            *word |= bit;
+            dbg->count[k]++;
+        } else if (!on && (*word & bit)) {
+            *word &= ~bit;
+            dbg->count[k]--;
+        }
+    }
+    refresh_armed(cpu);
+    return true;
+}
+
+void agc_debug_clear(agc_cpu_t *cpu, unsigned kinds) {
+    agc_debug_t *dbg = cpu->debug;
+    if (!dbg) return;
+
+    for (int k = 0; k < AGC_DEBUG_KINDS; k++) {
+        if (!(kinds & (1u << k))) continue;
+        memset(dbg->map[k], 0, sizeof(dbg->map[k]));
+        dbg->count[k] = 0;
+    }
+    refresh_armed(cpu);
+}
+
+size_t agc_debug_list(const agc_debug_t *dbg, agc_debug_kind_t kind, uint32_t *out, size_t max) {
+    const uint64_t *map = dbg->map[kind_bit(kind)];
+    size_t n = 0;
+    for (uint32_t w = 0; w < AGC_DEBUG_MAP_WORDS && n < max; w++) {
+        for (uint64_t bits = map[w]; bits && n < max; bits &= bits - 1)
+            out[n++] = w * 64 + (uint32_t)__builtin_ctzll(bits);
+    }
+    return n;
+}
+
+void agc_debug_access(agc_cpu_t *cpu, agc_word_t addr, agc_debug_kind_t kind) {
+    uint32_t phys = agc_phys_index(cpu->EB, cpu->FB, addr);
+    if (agc_debug_test(cpu->debug, kind_bit(kind), phys)) {
+        cpu->debug_hit |= (uint8_t)kind;
+        cpu->debug_hit_phys = phys;
+    }
+}
+
+/*
+ * Watchpoints are checked against the operand of the instruction about
+ * to run, then it runs through the normal step, then the breakpoint map
+ * is checked at the new Z.
+ */
+void agc_debug_step(agc_cpu_t *cpu) {
+    agc_memory_sync_banks(cpu);
+    agc_word_t instr = agc_memory_read_banked(cpu, cpu->Z);
+    uint8_t operand = agc_instr_operand[agc_get_opcode(instr)];
+    uint16_t address = agc_get_address(instr);
+
+    if ((operand & AGC_OPERAND_READ) && (cpu->debug_armed & AGC_DEBUG_READ))
+        agc_debug_access(cpu, address, AGC_DEBUG_READ);
+    if ((operand & AGC_OPERAND_WRITE) && (cpu->debug_armed & AGC_DEBUG_WRITE))
+        agc_debug_access(cpu, address, AGC_DEBUG_WRITE);
+
+    agc_cpu_step_switch(cpu);
+
+    if (cpu->debug_armed & AGC_DEBUG_EXEC) {
+        uint32_t phys = agc_phys_index(cpu->EB, cpu->FB, cpu->Z);
+        if (agc_debug_test(cpu->debug, 0, phys)) {
+            cpu->debug_hit |= AGC_DEBUG_EXEC;
+            cpu->debug_hit_phys = phys;
+        }
+    }
+}
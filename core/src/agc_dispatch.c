@@ -0,0 +1,445 @@
+#include "agc_cpu.h"
+#include "agc_memory.h"
+#include "agc_instructions.h"
+#include "agc_profiler.h"
+#include "agc_debug.h"
+#include "agc_trace.h"
+#include "agc_channels.h"
+#include "agc_sched.h"
+
+/*
+ * Interpreter cores.
+ *
+ * The default core runs agc_cpu_step() in a loop, which decodes with a
+ * switch and calls the agc_instr_* handlers. Defining AGC_THREADED_DISPATCH
+ * selects the threaded core below: handlers are inlined into one function
+ * and each ends by fetching and jumping straight to the next handler
+ * through a label table (computed goto on GCC/Clang, a switch elsewhere).
+ *
+ * AGC_SUPERBLOCKS adds a superblock tier (agc_superblock.c) on top of the
+ * default core.
+ *
+ * An instance with a per-instruction hook active - a profile attached
+ * (AGC_PROFILER builds), a trace attached, or breakpoints/watchpoints
+ * armed - is handed by either core to run_hooked(), which steps one
+ * instruction at a time. Otherwise the hooks cost one test on entry.
+ *
+ * Every core fires scheduled events (agc_sched.h) at the instruction
+ * boundary where they come due, before checking the stop conditions.
+ */
+
+/*
+ * Check the stop conditions that depend on Z alone.
+ */
+static inline agc_stop_reason_t check_stop_at(const agc_cpu_t *cpu, uint32_t mask, agc_word_t z) {
+    if ((mask & AGC_STOP_Z_RANGE) &&
+        z >= cpu->stop_z_lo && z <= cpu->stop_z_hi)
+        return AGC_STOP_Z_RANGE;
+
+    if (mask & AGC_STOP_BREAKPOINT) {
+        for (uint8_t i = 0; i < cpu->breakpoint_count; i++)
+            if (z == cpu->breakpoints[i])
+                return AGC_STOP_BREAKPOINT;
+    }
+
+    return AGC_STOP_NONE;
+}
+
+/*
+ * Check the armed stop conditions at an instruction boundary.
+ * Returns the first one that holds, or AGC_STOP_NONE.
+ */
+static inline agc_stop_reason_t check_stop(const agc_cpu_t *cpu, uint32_t mask) {
+    if ((mask & AGC_STOP_IO_WRITE) && cpu->out_written)
+        return AGC_STOP_IO_WRITE;
+
+    if ((mask & AGC_STOP_RUPT) && cpu->rupt_pending)
+        return AGC_STOP_RUPT;
+
+    if ((mask & AGC_STOP_CYCLE) && cpu->cycle_count >= cpu->stop_cycle)
+        return AGC_STOP_CYCLE;
+
+    return check_stop_at(cpu, mask, cpu->Z);
+}
+
+/*
+ * Idle loop fast-forward.
+ *
+ * This ISA has no conditional branches, so a backward TC closes a loop
+ * that repeats until something outside the CPU intervenes. If one pass
+ * over the loop body leaves A and every word it writes unchanged, each
+ * further pass only advances cycle_count. Such loops (a TC to itself is
+ * the common case) are skipped in whole iterations, up to the next
+ * scheduled event and within the instruction budget, so the final state
+ * is exactly what emulating every pass would give.
+ */
+#define AGC_IDLE_MAX_BODY 16
+
+typedef struct {
+    agc_word_t addr[AGC_IDLE_MAX_BODY];
+    agc_word_t value[AGC_IDLE_MAX_BODY];
+    int count;
+} idle_overlay_t;
+
+static agc_word_t idle_read(const agc_cpu_t *cpu, const idle_overlay_t *ov, agc_word_t addr) {
+    addr &= 077777;
+    for (int i = 0; i < ov->count; i++)
+        if (ov->addr[i] == addr) return ov->value[i];
+    return agc_memory_read_banked(cpu, addr);
+}
+
+static void idle_write(idle_overlay_t *ov, agc_word_t addr, agc_word_t value) {
+    addr &= 077777;
+    // Writes to fixed memory (ROM) are ignored
+    if (addr >= AGC_ERASE_BANK_SIZE) return;
+
+    int i = 0;
+    while (i < ov->count && ov->addr[i] != addr) i++;
+    if (i == ov->count) {
+        ov->addr[i] = addr;
+        ov->count++;
+    }
+    ov->value[i] = agc_normalize(value);
+}
+
+/*
+ * Called with Z at the target of the TC just retired from tc_pc.
+ * Returns the number of instructions skipped; cycle_count is advanced.
+ * Loops that pass a Z-based stop condition in mask are never skipped.
+ */
+static uint64_t idle_skip(agc_cpu_t *cpu, agc_word_t tc_pc, uint64_t budget, uint32_t mask) {
+    agc_word_t head = cpu->Z;
+    uint32_t len = (uint32_t)(tc_pc - head) + 1;
+    if (!cpu->idle_skip || len > AGC_IDLE_MAX_BODY || budget < len) return 0;
+
+    // Simulate one pass over an overlay of the words it writes
+    idle_overlay_t ov = { .count = 0 };
+    agc_word_t a = cpu->A;
+    uint64_t mct = 0;
+
+    for (agc_word_t pc = head; ; pc = agc_normalize(pc + 1)) {
+        if (mask && check_stop_at(cpu, mask, pc) != AGC_STOP_NONE) return 0;
+
+        agc_word_t instr = idle_read(cpu, &ov, pc);
+        uint16_t address = agc_get_address(instr);
+        uint8_t opcode = agc_get_opcode(instr);
+        mct += agc_instr_mct[opcode];
+
+        if (opcode == 0) {
+            // Only the closing TC may transfer control
+            if (pc != tc_pc || agc_normalize(address) != head) return 0;
+            break;
+        }
+        if (pc == tc_pc) return 0;
+
+        switch (opcode) {
+            case 1: {
+                agc_word_t temp = idle_read(cpu, &ov, address);
+                idle_write(&ov, address, a);
+                a = temp;
+                break;
+            }
+            case 2: idle_write(&ov, address, a); break;
+            case 3: a = idle_read(cpu, &ov, address); break;
+            default: break;
+        }
+    }
+
+    // The pass must be a fixed point of the machine state
+    if (a != cpu->A) return 0;
+    for (int i = 0; i < ov.count; i++)
+        if (ov.value[i] != agc_memory_read_banked(cpu, ov.addr[i])) return 0;
+
+    // Land at or before the next event, and strictly before a cycle stop
+    // so that the stop is still taken at an instruction boundary
+    uint64_t limit = cpu->next_event;
+    if ((mask & AGC_STOP_CYCLE) && cpu->stop_cycle - 1 < limit)
+        limit = cpu->stop_cycle - 1;
+
+    uint64_t passes = budget / len;
+    if (limit != UINT64_MAX) {
+        uint64_t until = limit > cpu->cycle_count ? limit - cpu->cycle_count : 0;
+        if (passes > until / mct) passes = until / mct;
+    }
+
+    cpu->cycle_count += passes * mct;
+    return passes * len;
+}
+
+static inline bool hooked(const agc_cpu_t *cpu) {
+#ifdef AGC_PROFILER
+    if (cpu->prof) return true;
+#endif
+    return cpu->debug_armed || cpu->trace;
+}
+
+static uint64_t run_hooked(agc_cpu_t *cpu, uint64_t count, uint32_t mask,
+                           agc_stop_reason_t *reason) {
+    for (uint64_t n = 0; n < count; ) {
+        AGC_PROF_RECORD(cpu);
+        if (cpu->trace)
+            agc_trace_record(cpu->trace, cpu);
+        if (cpu->debug_armed)
+            agc_debug_step(cpu);
+        else
+            agc_cpu_step_switch(cpu);
+        n++;
+        agc_sched_poll(cpu);
+        if ((mask & AGC_STOP_BREAKPOINT) && (cpu->debug_hit & AGC_DEBUG_EXEC)) {
+            *reason = AGC_STOP_BREAKPOINT;
+            return n;
+        }
+        if ((mask & AGC_STOP_WATCH) && (cpu->debug_hit & (AGC_DEBUG_READ | AGC_DEBUG_WRITE))) {
+            *reason = AGC_STOP_WATCH;
+            return n;
+        }
+        if (mask && (*reason = check_stop(cpu, mask)) != AGC_STOP_NONE)
+            return n;
+    }
+    *reason = AGC_STOP_COUNT;
+    return count;
+}
+
+#ifndef AGC_THREADED_DISPATCH
+
+static uint64_t run_core(agc_cpu_t *cpu, uint64_t count, uint32_t mask,
+                         agc_stop_reason_t *reason) {
+    if (hooked(cpu))
+        return run_hooked(cpu, count, mask, reason);
+    for (uint64_t n = 0; n < count; ) {
+#ifdef AGC_SUPERBLOCKS
+        // Hot fixed-memory code runs as a superblock. Z and time are only
+        // checked between blocks, so Z- and cycle-based stops keep it off.
+        if (cpu->Z >= AGC_ERASE_BANK_SIZE &&
+            !(mask & (AGC_STOP_BREAKPOINT | AGC_STOP_Z_RANGE | AGC_STOP_CYCLE))) {
+            uint64_t ran = agc_sb_run(cpu, count - n);
+            if (ran) {
+                n += ran;
+                agc_sched_poll(cpu);
+                if (mask && (*reason = check_stop(cpu, mask)) != AGC_STOP_NONE)
+                    return n;
+                continue;
+            }
+        }
+#endif
+        agc_word_t pc = cpu->Z;
+        agc_cpu_step_switch(cpu);
+        n++;
+        agc_sched_poll(cpu);
+        if (mask && (*reason = check_stop(cpu, mask)) != AGC_STOP_NONE)
+            return n;
+
+        // Backward TC: try to fast-forward an idle loop. The skip may land
+        // on an event, which then fires at that boundary as it would have.
+        if (agc_get_opcode(cpu->current_instruction) == 0 && cpu->Z <= pc) {
+            uint64_t skipped = idle_skip(cpu, pc, count - n, mask);
+            if (skipped) {
+                n += skipped;
+                agc_sched_poll(cpu);
+                if (mask && (*reason = check_stop(cpu, mask)) != AGC_STOP_NONE)
+                    return n;
+            }
+        }
+    }
+    *reason = AGC_STOP_COUNT;
+    return count;
+}
+
+#else
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(AGC_NO_COMPUTED_GOTO)
+#define AGC_COMPUTED_GOTO 1
+#endif
+
+static uint64_t run_core(agc_cpu_t *cpu, uint64_t count, uint32_t mask,
+                         agc_stop_reason_t *reason) {
+    uint64_t n = 0;
+    agc_word_t instr;
+    uint16_t address;
+    uint8_t opcode;
+    agc_word_t tc_pc;
+
+    if (hooked(cpu))
+        return run_hooked(cpu, count, mask, reason);
+
+    // No instruction writes EB/FB, so the bank cache stays valid for the run
+    agc_memory_sync_banks(cpu);
+
+    /*
+     * Fetch the word at Z, advance Z and decode. The AGC increments Z
+     * before execution, exactly as agc_cpu_step() does. Fixed memory is
+     * served from the rope's decoded side-table, erasable is decoded live.
+     */
+#define FETCH()                                                         \
+    do {                                                                \
+        const agc_decoded_t *page = cpu->decoded_page[(cpu->Z >> 10) & 037]; \
+        if (page) {                                                     \
+            const agc_decoded_t *d = &page[cpu->Z & 01777];             \
+            instr = d->word;                                            \
+            address = d->address;                                       \
+            opcode = d->handler;                                        \
+        } else {                                                        \
+            instr = agc_memory_read_banked(cpu, cpu->Z);                \
+            address = agc_get_address(instr);                           \
+            opcode = agc_get_opcode(instr);                             \
+        }                                                               \
+        cpu->current_instruction = instr;                               \
+        cpu->Z = agc_normalize(cpu->Z + 1);                             \
+    } while (0)
+
+    // Fire due events; a handler may have switched banks
+#define POLL()                                                          \
+    do {                                                                \
+        if (cpu->cycle_count >= cpu->next_event) {                      \
+            agc_sched_fire(cpu);                                        \
+            agc_memory_sync_banks(cpu);                                 \
+        }                                                               \
+    } while (0)
+
+    // Retire the instruction just executed and check for a stop
+#define RETIRE()                                                        \
+    do {                                                                \
+        cpu->cycle_count += agc_instr_mct[opcode];                      \
+        n++;                                                            \
+        POLL();                                                         \
+        if (mask && (*reason = check_stop(cpu, mask)) != AGC_STOP_NONE) \
+            goto done;                                                  \
+    } while (0)
+
+    // Backward TC from tc_pc: try to fast-forward an idle loop, firing
+    // an event the skip lands on
+#define IDLE_SKIP()                                                     \
+    do {                                                                \
+        uint64_t skipped = idle_skip(cpu, tc_pc, count - n, mask);      \
+        if (skipped) {                                                  \
+            n += skipped;                                               \
+            POLL();                                                     \
+            if (mask && (*reason = check_stop(cpu, mask)) != AGC_STOP_NONE) \
+                goto done;                                              \
+        }                                                               \
+    } while (0)
+
+#ifdef AGC_COMPUTED_GOTO
+    static const void *const dispatch[8] = {
+        &&op_TC, &&op_XCH, &&op_TS, &&op_CA,
+        &&op_none, &&op_none, &&op_none, &&op_none,
+    };
+
+#define DISPATCH()                                                      \
+    do {                                                                \
+        if (n == count) goto count_reached;                             \
+        FETCH();                                                        \
+        goto *dispatch[opcode];                                         \
+    } while (0)
+
+#define NEXT()                                                          \
+    do {                                                                \
+        RETIRE();                                                       \
+        DISPATCH();                                                     \
+    } while (0)
+
+    FETCH();
+    goto *dispatch[opcode];
+
+op_TC:
+    tc_pc = (agc_word_t)((cpu->Z - 1) & 077777);
+    agc_op_TC(cpu, address);
+    RETIRE();
+    if (cpu->Z <= tc_pc)
+        IDLE_SKIP();
+    DISPATCH();
+op_XCH:
+    agc_op_XCH(cpu, address);
+    NEXT();
+op_TS:
+    agc_op_TS(cpu, address);
+    NEXT();
+op_CA:
+    agc_op_CA(cpu, address);
+    NEXT();
+op_none:
+    // Unimplemented or invalid opcode, ignored as in agc_execute_instruction()
+    NEXT();
+#else
+    // Portable fallback: same inlined handlers behind a switch
+    while (n < count) {
+        FETCH();
+        tc_pc = (agc_word_t)((cpu->Z - 1) & 077777);
+        switch (opcode) {
+            case 0: agc_op_TC(cpu, address);  break;
+            case 1: agc_op_XCH(cpu, address); break;
+            case 2: agc_op_TS(cpu, address);  break;
+            case 3: agc_op_CA(cpu, address);  break;
+            default: break;
+        }
+        RETIRE();
+        if (opcode == 0 && cpu->Z <= tc_pc)
+            IDLE_SKIP();
+    }
+    goto count_reached;
+#endif
+
+count_reached:
+    *reason = AGC_STOP_COUNT;
+done:
+#undef FETCH
+#undef POLL
+#undef RETIRE
+#undef IDLE_SKIP
+#undef NEXT
+#undef DISPATCH
+    return n;
+}
+
+#endif // AGC_THREADED_DISPATCH
+
+/*
+ * With peripheral channels attached, run in slices and drain pending
+ * inputs at the instruction boundary before each one.
+ */
+static uint64_t run_sliced(agc_cpu_t *cpu, uint64_t count, uint32_t mask,
+                           agc_stop_reason_t *reason) {
+    if (!cpu->channels)
+        return run_core(cpu, count, mask, reason);
+
+    uint64_t n = 0;
+    while (n < count) {
+        agc_chan_drain(cpu);
+        uint64_t slice = count - n < AGC_CHAN_BATCH ? count - n : AGC_CHAN_BATCH;
+        n += run_core(cpu, slice, mask, reason);
+        if (*reason != AGC_STOP_COUNT)
+            return n;
+    }
+    *reason = AGC_STOP_COUNT;
+    return n;
+}
+
+uint64_t agc_cpu_exec(agc_cpu_t *cpu, uint64_t count) {
+    if (!cpu || count == 0) return 0;
+
+    agc_stop_reason_t reason;
+    agc_sched_poll(cpu);
+    return run_sliced(cpu, count, 0, &reason);
+}
+
+/*
+ * Batched execution with stop conditions.
+ * Runs the selected interpreter core in a tight loop; the armed
+ * conditions are checked at each instruction boundary.
+ */
+agc_stop_reason_t agc_cpu_run(agc_cpu_t *cpu, uint64_t max_instructions,
+                              uint32_t stop_mask, uint64_t *executed) {
+    if (executed) *executed = 0;
+    if (!cpu) return AGC_STOP_NONE;
+    if (max_instructions == 0) return AGC_STOP_COUNT;
+
+    // Only report channel writes and debug hits made during this run
+    cpu->out_written = 0;
+    cpu->debug_hit = 0;
+
+    agc_stop_reason_t reason = AGC_STOP_NONE;
+    agc_sched_poll(cpu);
+    uint64_t n = run_sliced(cpu, max_instructions, stop_mask & ~AGC_STOP_COUNT, &reason);
+    if (executed) *executed = n;
+    return reason;
+}
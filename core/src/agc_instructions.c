@@ -1,12 +1,17 @@
 #include "agc_instructions.h"
 #include "agc_memory.h"
 
+#include <stdio.h>
+
 /*
  * Main instruction dispatcher.
  * The AGC has only 8 primary opcodes (0–7).
  * Each opcode selects a family of instructions.
  */
 void agc_execute_instruction(agc_cpu_t *cpu, agc_word_t instr) {
+    // Handlers use the bank translation cache directly
+    agc_memory_sync_banks(cpu);
+
     uint8_t opcode = agc_get_opcode(instr);
     uint16_t address = agc_get_address(instr);
 
@@ -40,7 +45,7 @@ void agc_execute_instruction(agc_cpu_t *cpu, agc_word_t instr) {
  * This is the AGC equivalent of a branch/jump instruction.
  */
 void agc_instr_TC(agc_cpu_t *cpu, uint16_t address) {
-    cpu->Z = agc_normalize(address);
+    agc_op_TC(cpu, address);
 }
 
 /*
@@ -48,9 +53,7 @@ void agc_instr_TC(agc_cpu_t *cpu, uint16_t address) {
  * Swap the contents of register A with memory[address].
  */
 void agc_instr_XCH(agc_cpu_t *cpu, uint16_t address) {
-    agc_word_t temp = agc_memory_read(cpu, address);
-    agc_memory_write(cpu, address, cpu->A);
-    cpu->A = temp;
+    agc_op_XCH(cpu, address);
 }
 
 /*
@@ -61,7 +64,7 @@ void agc_instr_XCH(agc_cpu_t *cpu, uint16_t address) {
  * as per real AGC hardware behavior.
  */
 void agc_instr_TS(agc_cpu_t *cpu, uint16_t address) {
-    agc_memory_write(cpu, address, cpu->A);
+    agc_op_TS(cpu, address);
 }
 
 /*
@@ -71,5 +74,51 @@ void agc_instr_TS(agc_cpu_t *cpu, uint16_t address) {
  * This is equivalent to: A = M[addr]
  */
 void agc_instr_CA(agc_cpu_t *cpu, uint16_t address) {
-    cpu->A = agc_memory_read(cpu, address);
+    agc_op_CA(cpu, address);
+}
+
+/*
+ * Unimplemented or invalid opcode.
+ * Real AGC would trigger a restart; we ignore for now.
+ */
+static void agc_instr_none(agc_cpu_t *cpu, uint16_t address) {
+    (void)cpu; (void)address;
+}
+
+const agc_instr_fn agc_instr_table[8] = {
+    agc_instr_TC, agc_instr_XCH, agc_instr_TS, agc_instr_CA,
+    agc_instr_none, agc_instr_none, agc_instr_none, agc_instr_none,
+};
+
+/*
+ * Block II execution times in MCTs (11.72 us each).
+ * TC takes one memory cycle; the memory-reference instructions take two.
+ * Opcodes 4-7 are not implemented yet and are charged as TC.
+ */
+const uint8_t agc_instr_mct[8] = {
+    1,  // TC
+    2,  // XCH
+    2,  // TS
+    2,  // CA
+    1, 1, 1, 1,
+};
+
+const uint8_t agc_instr_operand[8] = {
+    0,                                      // TC
+    AGC_OPERAND_READ | AGC_OPERAND_WRITE,   // XCH
+    AGC_OPERAND_WRITE,                      // TS
+    AGC_OPERAND_READ,                       // CA
+    0, 0, 0, 0,
+};
+
+const char *const agc_instr_names[8] = {
+    "TC", "XCH", "TS", "CA", "CCS", "INDEX", "ADS", "BUSY",
+};
+
+/*
+ * Minimal disassembler for core opcodes, shared by the REPL and the
+ * trace decoder.
+ */
+void agc_disasm(agc_word_t instr, char *buf, size_t size) {
+    snprintf(buf, size, "%s %04o", agc_instr_names[agc_get_opcode(instr)], instr & 07777);
 }
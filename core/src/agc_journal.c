@@ -0,0 +1,188 @@
+#include "agc_journal.h"
+#include "agc_memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AGC_JOURNAL_MAGIC   0x4a434741u   // "AGCJ"
+#define AGC_JOURNAL_VERSION 1
+
+// On-disk header, followed by the start snapshot and the entries
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entry_size;
+    uint64_t count;
+    uint64_t end_cycle;
+} agc_journal_header_t;
+
+void agc_journal_init(agc_journal_t *j) {
+    memset(j, 0, sizeof(*j));
+}
+
+void agc_journal_free(agc_journal_t *j) {
+    free(j->entries);
+    agc_journal_init(j);
+}
+
+void agc_journal_begin(agc_journal_t *j, const agc_cpu_t *cpu) {
+    agc_snapshot_take(cpu, &j->start);
+    j->count = 0;
+    j->end_cycle = cpu->cycle_count;
+    j->recording = true;
+}
+
+void agc_journal_end(agc_journal_t *j, const agc_cpu_t *cpu) {
+    if (!j->recording) return;
+    j->end_cycle = cpu->cycle_count;
+    j->recording = false;
+}
+
+static bool journal_append(agc_journal_t *j, const agc_journal_entry_t *e) {
+    if (j->count == j->capacity) {
+        size_t capacity = j->capacity ? j->capacity * 2 : 256;
+        agc_journal_entry_t *entries = realloc(j->entries, capacity * sizeof(*entries));
+        if (!entries) return false;
+        j->entries = entries;
+        j->capacity = capacity;
+    }
+    j->entries[j->count++] = *e;
+    return true;
+}
+
+static void journal_apply(const agc_journal_t *j, agc_cpu_t *cpu, const agc_journal_entry_t *e) {
+    switch (e->kind) {
+        case AGC_JOURNAL_IN:
+            cpu->IN[e->addr & 15] = agc_normalize(e->value);
+            break;
+        case AGC_JOURNAL_POKE:
+            agc_memory_write(cpu, e->addr, e->value);
+            break;
+        case AGC_JOURNAL_EB:
+            cpu->EB = (uint8_t)e->value;
+            break;
+        case AGC_JOURNAL_FB:
+            cpu->FB = (uint8_t)e->value;
+            break;
+        case AGC_JOURNAL_EXTERNAL:
+            if (j && j->on_external) j->on_external(cpu, e, j->ctx);
+            break;
+        default:
+            break;
+    }
+}
+
+bool agc_journal_input(agc_journal_t *j, agc_cpu_t *cpu, agc_journal_kind_t kind,
+                       agc_word_t addr, agc_word_t value) {
+    agc_journal_entry_t e = {
+        .cycle = cpu->cycle_count,
+        .kind = (uint8_t)kind,
+        .addr = addr,
+        .value = value,
+    };
+
+    if (j && j->recording && !journal_append(j, &e))
+        return false;
+
+    journal_apply(j, cpu, &e);
+    return true;
+}
+
+/*
+ * Run until cycle_count reaches target. Recording stamps inputs at
+ * instruction boundaries of the same deterministic run, so the stop
+ * lands exactly on the recorded boundary.
+ */
+static void replay_until(agc_cpu_t *cpu, uint64_t target) {
+    if (cpu->cycle_count >= target) return;
+
+    uint64_t saved_stop = cpu->stop_cycle;
+    cpu->stop_cycle = target;
+    agc_cpu_run(cpu, UINT64_MAX, AGC_STOP_CYCLE, NULL);
+    cpu->stop_cycle = saved_stop;
+}
+
+bool agc_journal_replay(const agc_journal_t *j, agc_cpu_t *cpu) {
+    if (!agc_snapshot_restore(cpu, &j->start))
+        return false;
+
+    for (size_t i = 0; i < j->count; i++) {
+        replay_until(cpu, j->entries[i].cycle);
+        if (cpu->cycle_count != j->entries[i].cycle)
+            return false;   // Diverged: different rope or corrupt journal
+        journal_apply(j, cpu, &j->entries[i]);
+    }
+
+    replay_until(cpu, j->end_cycle);
+    return cpu->cycle_count == j->end_cycle;
+}
+
+bool agc_journal_save(const agc_journal_t *j, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+
+    agc_journal_header_t h = {
+        .magic = AGC_JOURNAL_MAGIC,
+        .version = AGC_JOURNAL_VERSION,
+        .entry_size = (uint16_t)sizeof(agc_journal_entry_t),
+        .count = j->count,
+        .end_cycle = j->end_cycle,
+    };
+
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+              fwrite(&j->start, sizeof(j->start), 1, f) == 1 &&
+              fwrite(j->entries, sizeof(agc_journal_entry_t), j->count, f) == j->count;
+
+    return fclose(f) == 0 && ok;
+}
+
+// Bytes between the current position and the end of the file, or -1
+static long remaining_bytes(FILE *f) {
+    long pos = ftell(f), end;
+    if (pos < 0 || fseek(f, 0, SEEK_END) != 0) return -1;
+    end = ftell(f);
+    if (fseek(f, pos, SEEK_SET) != 0 || end < pos) return -1;
+    return end - pos;
+}
+
+bool agc_journal_load(agc_journal_t *j, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+
+    agc_journal_header_t h;
+    agc_journal_t loaded;
+    agc_journal_init(&loaded);
+
+    bool ok = fread(&h, sizeof(h), 1, f) == 1 &&
+              h.magic == AGC_JOURNAL_MAGIC &&
+              h.version == AGC_JOURNAL_VERSION &&
+              h.entry_size == sizeof(agc_journal_entry_t) &&
+              fread(&loaded.start, sizeof(loaded.start), 1, f) == 1;
+
+    // The entries must fill the rest of the file exactly; this also
+    // bounds count before it sizes an allocation
+    long rest = ok ? remaining_bytes(f) : -1;
+    ok = ok && rest >= 0 && h.count <= SIZE_MAX / sizeof(agc_journal_entry_t) &&
+         h.count * sizeof(agc_journal_entry_t) == (uint64_t)rest;
+
+    if (ok && h.count) {
+        loaded.entries = malloc((size_t)h.count * sizeof(agc_journal_entry_t));
+        ok = loaded.entries &&
+             fread(loaded.entries, sizeof(agc_journal_entry_t), (size_t)h.count, f) == h.count;
+        loaded.count = loaded.capacity = ok ? h.count : 0;
+    }
+    fclose(f);
+
+    if (!ok) {
+        agc_journal_free(&loaded);
+        return false;
+    }
+
+    loaded.end_cycle = h.end_cycle;
+    loaded.on_external = j->on_external;
+    loaded.ctx = j->ctx;
+    free(j->entries);
+    *j = loaded;
+    return true;
+}
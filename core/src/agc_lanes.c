@@ -0,0 +1,241 @@
+#include "agc_lanes.h"
+#include "agc_instructions.h"
+
+#include <string.h>
+
+#define LANES_ALL ((1u << AGC_LANES) - 1)
+
+// pending_mct is 16 bits per lane; at most 2 MCT per step
+#define LANES_FLUSH_STEPS 8192
+
+/*
+ * 16 x 16-bit lane vectors. Compare results are all-ones per lane, so
+ * they double as blend masks.
+ */
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+typedef __m256i lv_t;
+
+static inline lv_t lv_load(const agc_word_t *p) { return _mm256_load_si256((const __m256i *)p); }
+static inline void lv_store(agc_word_t *p, lv_t v) { _mm256_store_si256((__m256i *)p, v); }
+static inline lv_t lv_set1(agc_word_t w) { return _mm256_set1_epi16((short)w); }
+static inline lv_t lv_eq(lv_t a, lv_t b) { return _mm256_cmpeq_epi16(a, b); }
+static inline lv_t lv_and(lv_t a, lv_t b) { return _mm256_and_si256(a, b); }
+static inline lv_t lv_andnot(lv_t m, lv_t a) { return _mm256_andnot_si256(m, a); }
+static inline lv_t lv_add(lv_t a, lv_t b) { return _mm256_add_epi16(a, b); }
+static inline lv_t lv_blend(lv_t dst, lv_t src, lv_t m) { return _mm256_blendv_epi8(dst, src, m); }
+static inline uint32_t lv_bits(lv_t m) {
+    __m128i packed = _mm_packs_epi16(_mm256_castsi256_si128(m), _mm256_extracti128_si256(m, 1));
+    return (uint32_t)_mm_movemask_epi8(packed);
+}
+
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+
+typedef struct { __m128i lo, hi; } lv_t;
+
+static inline lv_t lv_load(const agc_word_t *p) {
+    return (lv_t){ _mm_load_si128((const __m128i *)p), _mm_load_si128((const __m128i *)(p + 8)) };
+}
+static inline void lv_store(agc_word_t *p, lv_t v) {
+    _mm_store_si128((__m128i *)p, v.lo);
+    _mm_store_si128((__m128i *)(p + 8), v.hi);
+}
+static inline lv_t lv_set1(agc_word_t w) {
+    __m128i v = _mm_set1_epi16((short)w);
+    return (lv_t){ v, v };
+}
+static inline lv_t lv_eq(lv_t a, lv_t b) {
+    return (lv_t){ _mm_cmpeq_epi16(a.lo, b.lo), _mm_cmpeq_epi16(a.hi, b.hi) };
+}
+static inline lv_t lv_and(lv_t a, lv_t b) {
+    return (lv_t){ _mm_and_si128(a.lo, b.lo), _mm_and_si128(a.hi, b.hi) };
+}
+static inline lv_t lv_andnot(lv_t m, lv_t a) {
+    return (lv_t){ _mm_andnot_si128(m.lo, a.lo), _mm_andnot_si128(m.hi, a.hi) };
+}
+static inline lv_t lv_add(lv_t a, lv_t b) {
+    return (lv_t){ _mm_add_epi16(a.lo, b.lo), _mm_add_epi16(a.hi, b.hi) };
+}
+static inline lv_t lv_blend(lv_t dst, lv_t src, lv_t m) {
+    return (lv_t){ _mm_or_si128(_mm_andnot_si128(m.lo, dst.lo), _mm_and_si128(m.lo, src.lo)),
+                   _mm_or_si128(_mm_andnot_si128(m.hi, dst.hi), _mm_and_si128(m.hi, src.hi)) };
+}
+static inline uint32_t lv_bits(lv_t m) {
+    return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(m.lo, m.hi));
+}
+
+#else
+
+typedef struct { agc_word_t w[AGC_LANES]; } lv_t;
+
+static inline lv_t lv_load(const agc_word_t *p) {
+    lv_t v;
+    memcpy(v.w, p, sizeof(v.w));
+    return v;
+}
+static inline void lv_store(agc_word_t *p, lv_t v) { memcpy(p, v.w, sizeof(v.w)); }
+static inline lv_t lv_set1(agc_word_t x) {
+    lv_t v;
+    for (int i = 0; i < AGC_LANES; i++) v.w[i] = x;
+    return v;
+}
+static inline lv_t lv_eq(lv_t a, lv_t b) {
+    for (int i = 0; i < AGC_LANES; i++) a.w[i] = a.w[i] == b.w[i] ? 0xFFFF : 0;
+    return a;
+}
+static inline lv_t lv_and(lv_t a, lv_t b) {
+    for (int i = 0; i < AGC_LANES; i++) a.w[i] &= b.w[i];
+    return a;
+}
+static inline lv_t lv_andnot(lv_t m, lv_t a) {
+    for (int i = 0; i < AGC_LANES; i++) a.w[i] &= (agc_word_t)~m.w[i];
+    return a;
+}
+static inline lv_t lv_add(lv_t a, lv_t b) {
+    for (int i = 0; i < AGC_LANES; i++) a.w[i] = (agc_word_t)(a.w[i] + b.w[i]);
+    return a;
+}
+static inline lv_t lv_blend(lv_t dst, lv_t src, lv_t m) {
+    for (int i = 0; i < AGC_LANES; i++) dst.w[i] = (dst.w[i] & ~m.w[i]) | (src.w[i] & m.w[i]);
+    return dst;
+}
+static inline uint32_t lv_bits(lv_t m) {
+    uint32_t bits = 0;
+    for (int i = 0; i < AGC_LANES; i++) bits |= (uint32_t)(m.w[i] & 1) << i;
+    return bits;
+}
+
+#endif
+
+void agc_lanes_init(agc_lanes_t *s, const agc_rope_t *rope) {
+    memset(s, 0, sizeof(*s));
+    s->rope = rope ? rope : agc_default_rope();
+}
+
+static void flush_mct(agc_lanes_t *s) {
+    for (int i = 0; i < AGC_LANES; i++) {
+        s->cycle_count[i] += s->pending_mct[i];
+        s->pending_mct[i] = 0;
+    }
+}
+
+void agc_lanes_load(agc_lanes_t *s, int lane, const agc_cpu_t *cpu) {
+    s->A[lane] = cpu->A;
+    s->L[lane] = cpu->L;
+    s->Q[lane] = cpu->Q;
+    s->Z[lane] = cpu->Z;
+    s->EB[lane] = cpu->EB;
+    s->FB[lane] = cpu->FB;
+    s->BB[lane] = cpu->BB;
+    s->current_instruction[lane] = cpu->current_instruction;
+    s->cycle_count[lane] = cpu->cycle_count;
+    s->pending_mct[lane] = 0;
+    for (int a = 0; a < AGC_RAM_SIZE; a++)
+        s->erasable[a][lane] = cpu->erasable[a];
+}
+
+void agc_lanes_store(agc_lanes_t *s, int lane, agc_cpu_t *cpu) {
+    flush_mct(s);
+    cpu->A = s->A[lane];
+    cpu->L = s->L[lane];
+    cpu->Q = s->Q[lane];
+    cpu->Z = s->Z[lane];
+    cpu->EB = (uint8_t)s->EB[lane];
+    cpu->FB = (uint8_t)s->FB[lane];
+    cpu->BB = s->BB[lane];
+    cpu->current_instruction = s->current_instruction[lane];
+    cpu->cycle_count = s->cycle_count[lane];
+    for (int a = 0; a < AGC_RAM_SIZE; a++)
+        cpu->erasable[a] = s->erasable[a][lane];
+    cpu->dirty = UINT64_MAX;
+    agc_memory_rebank(cpu);
+}
+
+// Word at Z in fixed memory, translated the way agc_memory_rebank() maps pages
+static agc_word_t fetch_fixed(const agc_rope_t *rope, agc_word_t z, agc_word_t fb) {
+    int phys = (fb % (AGC_ROM_SIZE / AGC_FIXED_BANK_SIZE)) * AGC_FIXED_BANK_SIZE +
+               (((z >> 10) & 037) - 1) * AGC_ERASE_BANK_SIZE + (z & 01777);
+    return rope->words[phys < AGC_ROM_SIZE ? phys : AGC_ROM_SIZE - 1];
+}
+
+/*
+ * One lockstep step. Lane state from before the step (s->Z, s->EB,
+ * s->FB) picks the groups; each group updates only its own lanes, and
+ * every lane owns its erasable column, so groups cannot disturb one
+ * another within a step.
+ */
+static void lanes_step(agc_lanes_t *s) {
+    const lv_t mask15 = lv_set1(AGC_WORD_MASK);
+    const lv_t z0 = lv_load(s->Z), eb0 = lv_load(s->EB), fb0 = lv_load(s->FB);
+    lv_t Z = z0, A = lv_load(s->A);
+    lv_t ci = lv_load(s->current_instruction), mct = lv_load(s->pending_mct);
+    lv_t pend = lv_eq(z0, z0);
+    uint32_t bits = LANES_ALL;
+
+    do {
+        int lead = __builtin_ctz(bits);
+        agc_word_t z = s->Z[lead], eb = s->EB[lead], fb = s->FB[lead];
+        agc_word_t (*bank)[AGC_LANES] = &s->erasable[(eb % (AGC_RAM_SIZE / AGC_ERASE_BANK_SIZE)) * AGC_ERASE_BANK_SIZE];
+
+        lv_t g = lv_and(pend, lv_and(lv_eq(z0, lv_set1(z)),
+                                     lv_and(lv_eq(eb0, lv_set1(eb)), lv_eq(fb0, lv_set1(fb)))));
+        agc_word_t word;
+        if (z < AGC_ERASE_BANK_SIZE) {
+            // Code in erasable memory may differ per lane
+            lv_t row = lv_load(bank[z]);
+            word = bank[z][lead];
+            g = lv_and(g, lv_eq(row, lv_set1(word)));
+        } else {
+            word = fetch_fixed(s->rope, z, fb);
+        }
+        pend = lv_andnot(g, pend);
+        bits = lv_bits(pend);
+
+        uint8_t op = agc_get_opcode(word);
+        uint16_t addr = agc_get_address(word);
+        agc_word_t *opnd = bank[addr];
+
+        Z = lv_blend(Z, lv_set1(agc_normalize((agc_word_t)(z + 1))), g);
+        ci = lv_blend(ci, lv_set1(word), g);
+        mct = lv_add(mct, lv_and(g, lv_set1(agc_instr_mct[op])));
+
+        switch (op) {
+            case 0:     // TC
+                Z = lv_blend(Z, lv_set1(agc_normalize(addr)), g);
+                break;
+            case 1: {   // XCH
+                lv_t m = lv_load(opnd);
+                lv_store(opnd, lv_blend(m, lv_and(A, mask15), g));
+                A = lv_blend(A, m, g);
+                break;
+            }
+            case 2:     // TS
+                lv_store(opnd, lv_blend(lv_load(opnd), lv_and(A, mask15), g));
+                break;
+            case 3:     // CA
+                A = lv_blend(A, lv_load(opnd), g);
+                break;
+            default:
+                break;
+        }
+        s->groups++;
+    } while (bits);
+
+    lv_store(s->Z, Z);
+    lv_store(s->A, A);
+    lv_store(s->current_instruction, ci);
+    lv_store(s->pending_mct, mct);
+    s->steps++;
+}
+
+void agc_lanes_exec(agc_lanes_t *s, uint64_t steps) {
+    while (steps) {
+        uint64_t chunk = steps < LANES_FLUSH_STEPS ? steps : LANES_FLUSH_STEPS;
+        for (uint64_t i = 0; i < chunk; i++)
+            lanes_step(s);
+        flush_mct(s);
+        steps -= chunk;
+    }
+}
@@ -1,15 +1,56 @@
 #include "agc_memory.h"
+#include "agc_instructions.h"
+#include "agc_rope.h"
+#include "agc_debug.h"
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// AGC memory arrays
-static agc_word_t erasable[AGC_RAM_SIZE];
-static agc_word_t fixed[AGC_ROM_SIZE];
+// Default rope image. Erasable memory lives in each agc_cpu_t.
+static agc_rope_t fixed;
 
-// Bank size constants
-#define AGC_ERASE_BANK_SIZE  02000   // 1024 words (1K) per erasable bank
-#define AGC_FIXED_BANK_SIZE  010000  // 4096 words (4K) per fixed bank
+// Source of rope generations, unique across every rope in the process
+static atomic_uint_least32_t rope_generations;
+
+static void next_generation(agc_rope_t *rope) {
+    rope->generation = (uint32_t)atomic_fetch_add(&rope_generations, 1) + 1;
+}
+
+// Decode one rope word into its side-table entry
+static void decode_word(agc_rope_t *rope, int i) {
+    agc_word_t w = rope->words[i];
+    rope->decoded[i].word = w;
+    rope->decoded[i].address = agc_get_address(w);
+    rope->decoded[i].handler = agc_get_opcode(w);
+}
+
+/*
+ * Rebuild the bank translation cache.
+ * Clamps EB/FB to the banks that exist, exactly like the original
+ * per-access translation, and records which EB/FB it was built for.
+ */
+void agc_memory_rebank(agc_cpu_t *cpu) {
+    // Clamp EB to valid range (0 to AGC_RAM_SIZE/AGC_ERASE_BANK_SIZE - 1)
+    uint8_t eb = cpu->EB % (AGC_RAM_SIZE / AGC_ERASE_BANK_SIZE);
+    cpu->erasable_bank = &cpu->erasable[eb * AGC_ERASE_BANK_SIZE];
+
+    cpu->page[0] = cpu->erasable_bank;
+
+    // Clamp FB to valid range (0 to AGC_ROM_SIZE/AGC_FIXED_BANK_SIZE - 1)
+    // Fixed banks start on a page boundary, so each remaining page is
+    // either wholly inside the rope or wholly past its end.
+    uint8_t fb = cpu->FB % (AGC_ROM_SIZE / AGC_FIXED_BANK_SIZE);
+    int phys = fb * AGC_FIXED_BANK_SIZE;
+    cpu->decoded_page[0] = NULL;
+    for (int p = 1; p < 32; p++, phys += AGC_ERASE_BANK_SIZE) {
+        bool in_rope = phys < AGC_ROM_SIZE;
+        cpu->page[p] = in_rope ? &cpu->rope->words[phys] : NULL;
+        cpu->decoded_page[p] = in_rope ? &cpu->rope->decoded[phys] : NULL;
+    }
+
+    cpu->bank_key = (uint16_t)(cpu->EB | cpu->FB << 8);
+}
 
 /*
  * Read a word from AGC memory.
@@ -18,25 +59,10 @@ static agc_word_t fixed[AGC_ROM_SIZE];
  *   - Fixed addresses (02000+): use FB bank register
  */
 agc_word_t agc_memory_read(agc_cpu_t *cpu, agc_word_t addr) {
-    // Normalize address to 15 bits
-    addr = addr & 077777;
-
-    if (addr < AGC_ERASE_BANK_SIZE) {
-        // Erasable memory - banked via EB
-        // Clamp EB to valid range (0 to AGC_RAM_SIZE/AGC_ERASE_BANK_SIZE - 1)
-        uint8_t eb = cpu->EB % (AGC_RAM_SIZE / AGC_ERASE_BANK_SIZE);
-        int phys = eb * AGC_ERASE_BANK_SIZE + addr;
-        return erasable[phys];
-    } else {
-        // Fixed memory - banked via FB
-        // Clamp FB to valid range (0 to AGC_ROM_SIZE/AGC_FIXED_BANK_SIZE - 1)
-        uint8_t fb = cpu->FB % (AGC_ROM_SIZE / AGC_FIXED_BANK_SIZE);
-        int phys = fb * AGC_FIXED_BANK_SIZE + (addr - AGC_ERASE_BANK_SIZE);
-        // Ensure physical address is within bounds
-        if (phys < 0) phys = 0;
-        if (phys >= AGC_ROM_SIZE) phys = AGC_ROM_SIZE - 1;
-        return fixed[phys];
-    }
+    agc_memory_sync_banks(cpu);
+    if (cpu->debug_armed & AGC_DEBUG_READ)
+        agc_debug_access(cpu, addr, AGC_DEBUG_READ);
+    return agc_memory_read_banked(cpu, addr);
 }
 
 /*
@@ -45,66 +71,76 @@ agc_word_t agc_memory_read(agc_cpu_t *cpu, agc_word_t addr) {
  * Routes through EB/FB bank registers for proper bank switching.
  */
 void agc_memory_write(agc_cpu_t *cpu, agc_word_t addr, agc_word_t value) {
-    // Normalize address to 15 bits
-    addr = addr & 077777;
-
-    if (addr < AGC_ERASE_BANK_SIZE) {
-        // Erasable memory - banked via EB
-        // Clamp EB to valid range (0 to AGC_RAM_SIZE/AGC_ERASE_BANK_SIZE - 1)
-        uint8_t eb = cpu->EB % (AGC_RAM_SIZE / AGC_ERASE_BANK_SIZE);
-        int phys = eb * AGC_ERASE_BANK_SIZE + addr;
-        erasable[phys] = agc_normalize(value);
-    }
-    // Writes to fixed memory (ROM) are ignored
+    agc_memory_sync_banks(cpu);
+    if (cpu->debug_armed & AGC_DEBUG_WRITE)
+        agc_debug_access(cpu, addr, AGC_DEBUG_WRITE);
+    agc_memory_write_banked(cpu, addr, value);
 }
 
 /*
- * Load a ROM binary into fixed memory.
+ * Load a raw host-endian memory dump into fixed memory.
  * This will be used for Colossus/Luminary rope memory images.
  */
 void agc_memory_load_rom(const char *path) {
-    FILE *f = fopen(path, "rb");
-    if (!f) return;
+    agc_rope_load_format(&fixed, path, AGC_ROPE_HOST, NULL);
+}
 
-    fread(fixed, sizeof(agc_word_t), AGC_ROM_SIZE, f);
-    fclose(f);
+/*
+ * Load a ROM binary into a rope image.
+ * The format is detected from the file; see agc_rope.h.
+ */
+bool agc_rope_load(agc_rope_t *rope, const char *filename) {
+    return agc_rope_load_format(rope, filename, AGC_ROPE_AUTO, NULL);
+}
+
+/*
+ * Decode every rope word into the side-table used by the step loop.
+ */
+void agc_rope_decode(agc_rope_t *rope) {
+    for (int i = 0; i < AGC_ROM_SIZE; i++)
+        decode_word(rope, i);
+    next_generation(rope);
 }
 
 /*
- * Load a ROM binary into fixed memory.
- * Reads 2 bytes per word (big-endian) and masks to 15 bits.
+ * Load a ROM binary into the default rope image.
  */
 bool agc_load_rom(const char *filename) {
-    FILE *f = fopen(filename, "rb");
-    if (!f) return false;
+    return agc_rope_load(&fixed, filename);
+}
 
-    for (int i = 0; i < AGC_ROM_SIZE; i++) {
-        uint8_t hi, lo;
-        if (fread(&hi, 1, 1, f) != 1) break;
-        if (fread(&lo, 1, 1, f) != 1) break;
+bool agc_load_rom_format(const char *path, agc_rope_format_t format, agc_rope_info_t *info) {
+    return agc_rope_load_format(&fixed, path, format, info);
+}
 
-        uint16_t word = ((hi << 8) | lo) & 077777; // 15 bits
-        fixed[i] = word;
-    }
+const agc_rope_t *agc_default_rope(void) {
+    return &fixed;
+}
 
-    fclose(f);
-    return true;
+/*
+ * Point an instance at a rope image.
+ * The CPU only reads the rope, so one image can back many instances.
+ */
+void agc_memory_attach_rope(agc_cpu_t *cpu, const agc_rope_t *rope) {
+    cpu->rope = rope ? rope : &fixed;
+    agc_memory_rebank(cpu);
 }
 
 /*
  * Erasable memory helpers for testing.
  * Direct access to erasable memory without going through bank registers.
  */
-void agc_erasable_set(uint8_t bank, uint16_t addr, agc_word_t value) {
+void agc_erasable_set(agc_cpu_t *cpu, uint8_t bank, uint16_t addr, agc_word_t value) {
     uint8_t eb = bank % (AGC_RAM_SIZE / AGC_ERASE_BANK_SIZE);
     int phys = eb * AGC_ERASE_BANK_SIZE + (addr & 0777);
-    erasable[phys] = agc_normalize(value);
+    cpu->erasable[phys] = agc_normalize(value);
+    agc_memory_mark(cpu, (uint32_t)phys);
 }
 
-agc_word_t agc_erasable_get(uint8_t bank, uint16_t addr) {
+agc_word_t agc_erasable_get(const agc_cpu_t *cpu, uint8_t bank, uint16_t addr) {
     uint8_t eb = bank % (AGC_RAM_SIZE / AGC_ERASE_BANK_SIZE);
     int phys = eb * AGC_ERASE_BANK_SIZE + (addr & 0777);
-    return erasable[phys];
+    return cpu->erasable[phys];
 }
 
 /*
@@ -113,13 +149,15 @@ agc_word_t agc_erasable_get(uint8_t bank, uint16_t addr) {
  */
 void agc_rom_set(uint32_t addr, agc_word_t value) {
     if (addr < AGC_ROM_SIZE) {
-        fixed[addr] = agc_normalize(value);
+        fixed.words[addr] = agc_normalize(value);
+        decode_word(&fixed, (int)addr);
+        next_generation(&fixed);
     }
 }
 
 agc_word_t agc_rom_get(uint32_t addr) {
     if (addr < AGC_ROM_SIZE) {
-        return fixed[addr];
+        return fixed.words[addr];
     }
     return 0;
 }
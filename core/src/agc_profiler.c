@@ -0,0 +1,99 @@
+#include "agc_profiler.h"
+#include "agc_instructions.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void agc_prof_reset(agc_prof_t *prof) {
+    uint16_t key = prof->bank_key;
+    memset(prof, 0, sizeof(*prof));
+    prof->bank_key = key;
+}
+
+bool agc_prof_attach(agc_cpu_t *cpu, agc_prof_t *prof) {
+#ifdef AGC_PROFILER
+    if (prof)
+        prof->bank_key = (uint16_t)(cpu->EB | cpu->FB << 8);
+    cpu->prof = prof;
+    return true;
+#else
+    (void)cpu; (void)prof;
+    return false;
+#endif
+}
+
+// Insert into out[0..*n) kept sorted by count, hottest first
+static void keep_hottest(agc_prof_hot_t *out, size_t *n, size_t max, const agc_prof_hot_t *h) {
+    if (*n == max && out[max - 1].count >= h->count)
+        return;
+    size_t i = *n < max ? (*n)++ : max - 1;
+    while (i > 0 && out[i - 1].count < h->count) {
+        out[i] = out[i - 1];
+        i--;
+    }
+    out[i] = *h;
+}
+
+size_t agc_prof_hottest(const agc_prof_t *prof, const agc_cpu_t *cpu,
+                        agc_prof_hot_t *out, size_t max) {
+    size_t n = 0;
+    if (max == 0) return 0;
+
+    for (int i = 0; i < AGC_RAM_SIZE; i++) {
+        if (!prof->erasable[i]) continue;
+        agc_prof_hot_t h = {
+            .fixed = false,
+            .bank = (uint8_t)(i / AGC_ERASE_BANK_SIZE),
+            .addr = (agc_word_t)(i % AGC_ERASE_BANK_SIZE),
+            .word = cpu->erasable[i],
+            .count = prof->erasable[i],
+        };
+        keep_hottest(out, &n, max, &h);
+    }
+    for (int i = 0; i < AGC_ROM_SIZE; i++) {
+        if (!prof->fixed[i]) continue;
+        agc_prof_hot_t h = {
+            .fixed = true,
+            .bank = (uint8_t)(i / AGC_FIXED_BANK_SIZE),
+            .addr = (agc_word_t)(AGC_ERASE_BANK_SIZE + i % AGC_FIXED_BANK_SIZE),
+            .word = cpu->rope->words[i],
+            .count = prof->fixed[i],
+        };
+        keep_hottest(out, &n, max, &h);
+    }
+    return n;
+}
+
+/*
+ * Flat export, one counter per line:
+ *   instructions <n>
+ *   opcode <name> <n>
+ *   switch EB|FB <bank> <n>
+ *   addr E|F <bank> <octal addr> <n>
+ */
+bool agc_prof_export(const agc_prof_t *prof, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+
+    fprintf(f, "# agc profile v1\n");
+    fprintf(f, "instructions\t%llu\n", (unsigned long long)prof->instructions);
+    fprintf(f, "past_end\t%llu\n", (unsigned long long)prof->past_end);
+    for (int op = 0; op < 8; op++)
+        fprintf(f, "opcode\t%s\t%llu\n", agc_instr_names[op], (unsigned long long)prof->opcode[op]);
+    for (int b = 0; b < 256; b++) {
+        if (prof->eb_enter[b])
+            fprintf(f, "switch\tEB\t%d\t%llu\n", b, (unsigned long long)prof->eb_enter[b]);
+        if (prof->fb_enter[b])
+            fprintf(f, "switch\tFB\t%d\t%llu\n", b, (unsigned long long)prof->fb_enter[b]);
+    }
+    for (int i = 0; i < AGC_RAM_SIZE; i++)
+        if (prof->erasable[i])
+            fprintf(f, "addr\tE\t%d\t%04o\t%llu\n", i / AGC_ERASE_BANK_SIZE,
+                    i % AGC_ERASE_BANK_SIZE, (unsigned long long)prof->erasable[i]);
+    for (int i = 0; i < AGC_ROM_SIZE; i++)
+        if (prof->fixed[i])
+            fprintf(f, "addr\tF\t%d\t%04o\t%llu\n", i / AGC_FIXED_BANK_SIZE,
+                    AGC_ERASE_BANK_SIZE + i % AGC_FIXED_BANK_SIZE, (unsigned long long)prof->fixed[i]);
+
+    return fclose(f) == 0;
+}
@@ -0,0 +1,343 @@
+#define _DEFAULT_SOURCE     // MAP_ANONYMOUS
+
+#include "agc_rope.h"
+
+#include <ctype.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Words per bank in file order; BANK=n in octal source starts at n * 02000
+#define ROPE_FILE_BANK  02000
+
+// Bytes sniffed when deciding whether an image is text
+#define ROPE_SNIFF      4096
+
+static bool host_is_big_endian(void) {
+    const uint16_t probe = 1;
+    return *(const uint8_t *)&probe == 0;
+}
+
+static bool has_suffix(const char *s, const char *suffix) {
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+static bool looks_like_text(const uint8_t *p, size_t size) {
+    if (size > ROPE_SNIFF) size = ROPE_SNIFF;
+    for (size_t i = 0; i < size; i++)
+        if (!isprint(p[i]) && !isspace(p[i]))
+            return false;
+    return true;
+}
+
+// True if every byte at offset `hi` within each word is a valid high byte
+static bool high_bytes_fit(const uint8_t *p, size_t size, int hi) {
+    for (size_t i = (size_t)hi; i < size; i += 2)
+        if (p[i] & 0x80)
+            return false;
+    return true;
+}
+
+static agc_rope_format_t detect_format(const char *path, const uint8_t *p, size_t size) {
+    if (has_suffix(path, ".binsource") || looks_like_text(p, size))
+        return AGC_ROPE_BINSOURCE;
+    // A big-endian dump keeps the high byte first, a little-endian host
+    // dump second; only pick the host order when it alone fits 15 bits
+    if (!host_is_big_endian() && !high_bytes_fit(p, size, 0) && high_bytes_fit(p, size, 1))
+        return AGC_ROPE_HOST;
+    return AGC_ROPE_BIN;
+}
+
+static long parse_binary(const uint8_t *p, size_t size, bool big_endian, agc_word_t *words) {
+    if (size % 2 || size / 2 > AGC_ROM_SIZE)
+        return -1;
+    size_t n = size / 2;
+    int hi = big_endian ? 0 : 1;
+    for (size_t i = 0; i < n; i++, p += 2)
+        words[i] = (agc_word_t)((p[hi] << 8 | p[hi ^ 1]) & 077777);
+    return (long)n;
+}
+
+static long parse_octal(const char *p, const char *end, agc_word_t *words) {
+    size_t cursor = 0, n = 0;
+
+    while (p < end) {
+        if (isspace((unsigned char)*p)) {
+            p++;
+        } else if (*p == ';') {
+            while (p < end && *p != '\n') p++;
+        } else if (end - p > 5 && strncmp(p, "BANK=", 5) == 0) {
+            size_t bank = 0;
+            p += 5;
+            if (p == end || *p < '0' || *p > '7') return -1;
+            while (p < end && *p >= '0' && *p <= '7')
+                bank = bank * 8 + (size_t)(*p++ - '0');
+            cursor = bank * ROPE_FILE_BANK;
+        } else {
+            unsigned value = 0;
+            int digits = 0;
+            while (p < end && *p >= '0' && *p <= '7' && digits < 6) {
+                value = value * 8 + (unsigned)(*p++ - '0');
+                digits++;
+            }
+            if (digits == 0 || value > 077777 || cursor >= AGC_ROM_SIZE)
+                return -1;
+            if (p < end && !isspace((unsigned char)*p) && *p != ';')
+                return -1;
+            words[cursor++] = (agc_word_t)value;
+            if (cursor > n) n = cursor;
+        }
+    }
+    return (long)n;
+}
+
+/*
+ * Map the image file and parse it into words[AGC_ROM_SIZE]. Words the
+ * image does not cover are left as they were.
+ */
+static bool parse_image(const char *path, agc_rope_format_t format,
+                        agc_word_t *words, agc_rope_info_t *info) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    const uint8_t *p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+
+    if (format == AGC_ROPE_AUTO)
+        format = detect_format(path, p, size);
+
+    long n;
+    switch (format) {
+        case AGC_ROPE_BIN:
+            n = parse_binary(p, size, true, words);
+            break;
+        case AGC_ROPE_HOST:
+            n = parse_binary(p, size, host_is_big_endian(), words);
+            break;
+        case AGC_ROPE_BINSOURCE:
+            n = parse_octal((const char *)p, (const char *)p + size, words);
+            break;
+        default:
+            n = -1;
+            break;
+    }
+    munmap((void *)p, size);
+
+    if (n < 0) return false;
+    if (info) {
+        info->format = format;
+        info->file_size = size;
+        info->words = (size_t)n;
+    }
+    return true;
+}
+
+bool agc_rope_load_format(agc_rope_t *rope, const char *path,
+                          agc_rope_format_t format, agc_rope_info_t *info) {
+    agc_word_t *words = calloc(AGC_ROM_SIZE, sizeof(*words));
+    if (!words) return false;
+
+    bool ok = parse_image(path, format, words, info);
+    if (ok) {
+        memcpy(rope->words, words, sizeof(rope->words));
+        agc_rope_decode(rope);
+        if (info) info->checksum = agc_rope_checksum(rope);
+    }
+    free(words);
+    return ok;
+}
+
+const agc_rope_t *agc_rope_map(const char *path, agc_rope_format_t format, agc_rope_info_t *info) {
+    agc_rope_t *rope = mmap(NULL, sizeof(*rope), PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (rope == MAP_FAILED) return NULL;
+
+    // Anonymous pages start zeroed, so a short image needs no clearing
+    if (!parse_image(path, format, rope->words, info)) {
+        munmap(rope, sizeof(*rope));
+        return NULL;
+    }
+    agc_rope_decode(rope);
+    if (info) info->checksum = agc_rope_checksum(rope);
+
+    mprotect(rope, sizeof(*rope), PROT_READ);
+    return rope;
+}
+
+void agc_rope_unmap(const agc_rope_t *rope) {
+    if (rope)
+        munmap((void *)rope, sizeof(*rope));
+}
+
+uint64_t agc_rope_checksum(const agc_rope_t *rope) {
+    uint64_t h = 14695981039346656037ULL;
+    for (int i = 0; i < AGC_ROM_SIZE; i++) {
+        agc_word_t w = rope->words[i];
+        h = (h ^ (w & 0xff)) * 1099511628211ULL;
+        h = (h ^ (w >> 8)) * 1099511628211ULL;
+    }
+    return h;
+}
+
+const char *agc_rope_format_name(agc_rope_format_t format) {
+    switch (format) {
+        case AGC_ROPE_BIN:       return "big-endian bin";
+        case AGC_ROPE_HOST:      return "host-endian dump";
+        case AGC_ROPE_BINSOURCE: return "octal binsource";
+        default:                 return "auto";
+    }
+}
+
+// Resident image shared by every acquirer of the same contents
+typedef struct rope_image {
+    struct rope_image *next;
+    const agc_rope_t *rope;
+    agc_rope_info_t info;
+    unsigned refs;
+} rope_image_t;
+
+// Path that resolved to an image, with the file identity it had then
+typedef struct rope_path {
+    struct rope_path *next;
+    rope_image_t *image;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    char path[];
+} rope_path_t;
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static rope_image_t *images;
+static rope_path_t *paths;
+
+static bool same_file(const rope_path_t *p, const struct stat *st) {
+    return p->dev == st->st_dev && p->ino == st->st_ino && p->size == st->st_size &&
+           p->mtime.tv_sec == st->st_mtim.tv_sec && p->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+static void drop_path(rope_path_t **link) {
+    rope_path_t *p = *link;
+    *link = p->next;
+    free(p);
+}
+
+static rope_image_t *find_image(const agc_rope_t *rope, uint64_t checksum) {
+    for (rope_image_t *img = images; img; img = img->next)
+        if (img->info.checksum == checksum &&
+            memcmp(img->rope->words, rope->words, sizeof(rope->words)) == 0)
+            return img;
+    return NULL;
+}
+
+// Load path as a new image, or fold it into a resident one with equal words
+static rope_image_t *load_image(const char *path) {
+    agc_rope_info_t info;
+    const agc_rope_t *rope = agc_rope_map(path, AGC_ROPE_AUTO, &info);
+    if (!rope) return NULL;
+
+    rope_image_t *img = find_image(rope, info.checksum);
+    if (img) {
+        agc_rope_unmap(rope);
+        return img;
+    }
+
+    img = calloc(1, sizeof(*img));
+    if (!img) {
+        agc_rope_unmap(rope);
+        return NULL;
+    }
+    img->rope = rope;
+    img->info = info;
+    img->next = images;
+    images = img;
+    return img;
+}
+
+const agc_rope_t *agc_rope_acquire(const char *path, agc_rope_info_t *info) {
+    struct stat st;
+    if (stat(path, &st) != 0) return NULL;
+
+    pthread_mutex_lock(&registry_lock);
+
+    rope_image_t *img = NULL;
+    for (rope_path_t **link = &paths; *link; link = &(*link)->next) {
+        if (strcmp((*link)->path, path) != 0) continue;
+        if (same_file(*link, &st))
+            img = (*link)->image;
+        else
+            drop_path(link);    // File changed since; look it up afresh
+        break;
+    }
+
+    if (!img) {
+        size_t len = strlen(path) + 1;
+        rope_path_t *p = malloc(sizeof(*p) + len);
+        img = p ? load_image(path) : NULL;
+        if (!img) {
+            free(p);
+            pthread_mutex_unlock(&registry_lock);
+            return NULL;
+        }
+        memcpy(p->path, path, len);
+        p->image = img;
+        p->dev = st.st_dev;
+        p->ino = st.st_ino;
+        p->size = st.st_size;
+        p->mtime = st.st_mtim;
+        p->next = paths;
+        paths = p;
+    }
+
+    img->refs++;
+    if (info) *info = img->info;
+    const agc_rope_t *rope = img->rope;
+
+    pthread_mutex_unlock(&registry_lock);
+    return rope;
+}
+
+void agc_rope_release(const agc_rope_t *rope) {
+    if (!rope) return;
+    pthread_mutex_lock(&registry_lock);
+
+    for (rope_image_t **link = &images; *link; link = &(*link)->next) {
+        rope_image_t *img = *link;
+        if (img->rope != rope) continue;
+        if (--img->refs == 0) {
+            for (rope_path_t **p = &paths; *p; ) {
+                if ((*p)->image == img)
+                    drop_path(p);
+                else
+                    p = &(*p)->next;
+            }
+            *link = img->next;
+            agc_rope_unmap(img->rope);
+            free(img);
+        }
+        break;
+    }
+
+    pthread_mutex_unlock(&registry_lock);
+}
+
+size_t agc_rope_resident(void) {
+    size_t n = 0;
+    pthread_mutex_lock(&registry_lock);
+    for (rope_image_t *img = images; img; img = img->next)
+        n++;
+    pthread_mutex_unlock(&registry_lock);
+    return n;
+}
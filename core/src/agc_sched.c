@@ -0,0 +1,228 @@
+/* agc_sched.c - Cycle-ordered event scheduler and the TIME1..TIME6 counters */
+#include "agc_sched.h"
+#include "agc_memory.h"
+
+#include <string.h>
+
+static bool before(const agc_event_t *a, const agc_event_t *b) {
+    if (a->cycle != b->cycle) return a->cycle < b->cycle;
+    return (int32_t)(a->id - b->id) < 0;
+}
+
+static void sift_up(agc_sched_t *s, uint32_t i) {
+    agc_event_t ev = s->heap[i];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!before(&ev, &s->heap[parent])) break;
+        s->heap[i] = s->heap[parent];
+        i = parent;
+    }
+    s->heap[i] = ev;
+}
+
+static void sift_down(agc_sched_t *s, uint32_t i) {
+    agc_event_t ev = s->heap[i];
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= s->count) break;
+        if (child + 1 < s->count && before(&s->heap[child + 1], &s->heap[child]))
+            child++;
+        if (!before(&s->heap[child], &ev)) break;
+        s->heap[i] = s->heap[child];
+        i = child;
+    }
+    s->heap[i] = ev;
+}
+
+static void remove_at(agc_sched_t *s, uint32_t i) {
+    s->heap[i] = s->heap[--s->count];
+    if (i < s->count) {
+        sift_down(s, i);
+        sift_up(s, i);
+    }
+}
+
+// Handlers may schedule and cancel; fire publishes next_event when done
+static void update_next(agc_cpu_t *cpu) {
+    agc_sched_t *s = cpu->sched;
+    if (s && s->firing) return;
+    cpu->next_event = s && s->count ? s->heap[0].cycle : UINT64_MAX;
+}
+
+void agc_sched_init(agc_sched_t *sched) {
+    memset(sched, 0, sizeof(*sched));
+    sched->next_id = 1;
+}
+
+void agc_sched_attach(agc_cpu_t *cpu, agc_sched_t *sched) {
+    cpu->sched = sched;
+    update_next(cpu);
+}
+
+uint32_t agc_sched_at(agc_cpu_t *cpu, uint64_t cycle, agc_event_fn fn, void *ctx) {
+    agc_sched_t *s = cpu->sched;
+    if (!s || s->count == AGC_SCHED_MAX) return 0;
+
+    // From a handler, "now" is the boundary being served: defer to the next
+    if (s->firing && cycle <= cpu->cycle_count)
+        cycle = cpu->cycle_count + 1;
+
+    uint32_t id = s->next_id++;
+    if (s->next_id == 0) s->next_id = 1;
+
+    s->heap[s->count] = (agc_event_t){ .cycle = cycle, .id = id, .fn = fn, .ctx = ctx };
+    sift_up(s, s->count++);
+    update_next(cpu);
+    return id;
+}
+
+uint32_t agc_sched_after(agc_cpu_t *cpu, uint64_t delay, agc_event_fn fn, void *ctx) {
+    return agc_sched_at(cpu, cpu->cycle_count + delay, fn, ctx);
+}
+
+bool agc_sched_cancel(agc_cpu_t *cpu, uint32_t id) {
+    agc_sched_t *s = cpu->sched;
+    if (!s || id == 0) return false;
+
+    // The queue is small; a scan beats keeping positions up to date
+    for (uint32_t i = 0; i < s->count; i++) {
+        if (s->heap[i].id == id) {
+            remove_at(s, i);
+            update_next(cpu);
+            return true;
+        }
+    }
+    return false;
+}
+
+void agc_sched_fire(agc_cpu_t *cpu) {
+    agc_sched_t *s = cpu->sched;
+    if (!s) {
+        cpu->next_event = UINT64_MAX;
+        return;
+    }
+
+    // Counter cycles advance cycle_count, so more may come due meanwhile
+    s->firing = true;
+    while (s->count && s->heap[0].cycle <= cpu->cycle_count) {
+        agc_event_t ev = s->heap[0];
+        remove_at(s, 0);
+        s->fired++;
+        ev.fn(cpu, ev.ctx);
+    }
+    s->firing = false;
+    update_next(cpu);
+}
+
+/*
+ * Timers.
+ *
+ * Ticks are kept in clock pulses so that the 10 ms period, which is not
+ * a whole number of MCTs, does not drift; each tick fires at the first
+ * MCT boundary at or after its pulse.
+ */
+
+static uint64_t pulse_cycle(uint64_t pulse) {
+    return (pulse + AGC_PULSES_PER_MCT - 1) / AGC_PULSES_PER_MCT;
+}
+
+// First pulse after now that is phase plus a whole number of periods
+static uint64_t next_tick(uint64_t now, uint64_t period, uint64_t phase) {
+    if (now < phase) return phase;
+    return phase + ((now - phase) / period + 1) * period;
+}
+
+// One PINC counter cycle; true when the cell overflows
+static bool pinc(agc_cpu_t *cpu, agc_word_t cell) {
+    agc_word_t v = cpu->erasable[cell];
+    cpu->cycle_count++;
+    agc_memory_mark(cpu, cell);
+    if (v == 037777) {
+        cpu->erasable[cell] = 0;
+        return true;
+    }
+    cpu->erasable[cell] = agc_add(v, 1);
+    return false;
+}
+
+static void tick_cs(agc_cpu_t *cpu, void *ctx) {
+    agc_sched_t *s = ctx;
+    if (pinc(cpu, AGC_TIME1))
+        pinc(cpu, AGC_TIME2);
+    if (pinc(cpu, AGC_TIME3))
+        agc_rupt_request(cpu, AGC_RUPT_T3);
+    if (pinc(cpu, AGC_TIME5))
+        agc_rupt_request(cpu, AGC_RUPT_T5);
+
+    s->cs_pulse += AGC_PULSES_CS;
+    s->cs_id = agc_sched_at(cpu, pulse_cycle(s->cs_pulse), tick_cs, s);
+}
+
+static void tick_t4(agc_cpu_t *cpu, void *ctx) {
+    agc_sched_t *s = ctx;
+    if (pinc(cpu, AGC_TIME4))
+        agc_rupt_request(cpu, AGC_RUPT_T4);
+
+    s->t4_pulse += AGC_PULSES_CS;
+    s->t4_id = agc_sched_at(cpu, pulse_cycle(s->t4_pulse), tick_t4, s);
+}
+
+// DINC: one step toward zero, or T6RUPT on a zero
+static void tick_t6(agc_cpu_t *cpu, void *ctx) {
+    agc_sched_t *s = ctx;
+    s->t6_id = 0;
+    if (!(cpu->OUT[AGC_CHAN_TIME6] & AGC_TIME6_ENABLE)) return;
+
+    agc_word_t v = cpu->erasable[AGC_TIME6];
+    cpu->cycle_count++;
+    if (v == 0 || v == AGC_WORD_MASK) {
+        agc_rupt_request(cpu, AGC_RUPT_T6);
+        cpu->OUT[AGC_CHAN_TIME6] &= (agc_word_t)~AGC_TIME6_ENABLE;
+        return;
+    }
+    cpu->erasable[AGC_TIME6] = agc_is_negative(v) ? v + 1 : v - 1;
+    agc_memory_mark(cpu, AGC_TIME6);
+
+    s->t6_pulse += AGC_PULSES_T6;
+    s->t6_id = agc_sched_at(cpu, pulse_cycle(s->t6_pulse), tick_t6, s);
+}
+
+void agc_sched_time6(agc_cpu_t *cpu) {
+    agc_sched_t *s = cpu->sched;
+    if (!s || !s->timers || s->t6_id ||
+        !(cpu->OUT[AGC_CHAN_TIME6] & AGC_TIME6_ENABLE))
+        return;
+
+    s->t6_pulse = next_tick(cpu->cycle_count * AGC_PULSES_PER_MCT, AGC_PULSES_T6, 0);
+    s->t6_id = agc_sched_at(cpu, pulse_cycle(s->t6_pulse), tick_t6, s);
+}
+
+bool agc_sched_timers(agc_cpu_t *cpu, bool on) {
+    agc_sched_t *s = cpu->sched;
+    if (!s) return false;
+
+    if (!on) {
+        agc_sched_cancel(cpu, s->cs_id);
+        agc_sched_cancel(cpu, s->t4_id);
+        agc_sched_cancel(cpu, s->t6_id);
+        s->cs_id = s->t4_id = s->t6_id = 0;
+        s->timers = false;
+        return true;
+    }
+    if (s->timers) return true;
+
+    uint64_t now = cpu->cycle_count * AGC_PULSES_PER_MCT;
+    s->cs_pulse = next_tick(now, AGC_PULSES_CS, 0);
+    s->t4_pulse = next_tick(now, AGC_PULSES_CS, AGC_PULSES_T4);
+    s->cs_id = agc_sched_at(cpu, pulse_cycle(s->cs_pulse), tick_cs, s);
+    s->t4_id = agc_sched_at(cpu, pulse_cycle(s->t4_pulse), tick_t4, s);
+    s->timers = s->cs_id && s->t4_id;
+    if (!s->timers) {
+        agc_sched_cancel(cpu, s->cs_id);
+        agc_sched_cancel(cpu, s->t4_id);
+        s->cs_id = s->t4_id = 0;
+        return false;
+    }
+    agc_sched_time6(cpu);
+    return true;
+}
@@ -0,0 +1,51 @@
+#include "agc_snapshot.h"
+#include "agc_memory.h"
+
+#include <string.h> // memcpy
+
+void agc_snapshot_take(const agc_cpu_t *cpu, agc_snapshot_t *snap) {
+    snap->magic = AGC_SNAPSHOT_MAGIC;
+    snap->version = AGC_SNAPSHOT_VERSION;
+    snap->size = (uint16_t)sizeof(agc_snapshot_t);
+
+    snap->A = cpu->A;
+    snap->L = cpu->L;
+    snap->Q = cpu->Q;
+    snap->Z = cpu->Z;
+    snap->EB = cpu->EB;
+    snap->FB = cpu->FB;
+    snap->BB = cpu->BB;
+    snap->reserved = 0;
+    snap->current_instruction = cpu->current_instruction;
+    snap->cycle_count = cpu->cycle_count;
+
+    memcpy(snap->IN, cpu->IN, sizeof(snap->IN));
+    memcpy(snap->OUT, cpu->OUT, sizeof(snap->OUT));
+    memcpy(snap->erasable, cpu->erasable, sizeof(snap->erasable));
+}
+
+bool agc_snapshot_restore(agc_cpu_t *cpu, const agc_snapshot_t *snap) {
+    if (snap->magic != AGC_SNAPSHOT_MAGIC ||
+        snap->version != AGC_SNAPSHOT_VERSION ||
+        snap->size != sizeof(agc_snapshot_t))
+        return false;
+
+    cpu->A = snap->A;
+    cpu->L = snap->L;
+    cpu->Q = snap->Q;
+    cpu->Z = snap->Z;
+    cpu->EB = snap->EB;
+    cpu->FB = snap->FB;
+    cpu->BB = snap->BB;
+    cpu->current_instruction = snap->current_instruction;
+    cpu->cycle_count = snap->cycle_count;
+
+    memcpy(cpu->IN, snap->IN, sizeof(cpu->IN));
+    memcpy(cpu->OUT, snap->OUT, sizeof(cpu->OUT));
+    memcpy(cpu->erasable, snap->erasable, sizeof(snap->erasable));
+    cpu->dirty = UINT64_MAX;
+
+    // EB/FB may have changed under the bank translation cache
+    agc_memory_rebank(cpu);
+    return true;
+}
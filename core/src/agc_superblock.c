@@ -0,0 +1,136 @@
+#include "agc_cpu.h"
+#include "agc_memory.h"
+#include "agc_instructions.h"
+
+#include <string.h> // memset
+
+#ifdef AGC_SUPERBLOCKS
+
+/*
+ * Pre-bound handlers. Same semantics as agc_op_*, with the operand
+ * already translated to an erasable word.
+ */
+static void sb_TC(agc_cpu_t *cpu, const agc_sb_op_t *op) {
+    cpu->Z = op->target;
+}
+
+static void sb_XCH(agc_cpu_t *cpu, const agc_sb_op_t *op) {
+    agc_word_t temp = *op->operand;
+    *op->operand = agc_normalize(cpu->A);
+    agc_memory_mark(cpu, (uint32_t)(op->operand - cpu->erasable));
+    cpu->A = temp;
+}
+
+static void sb_TS(agc_cpu_t *cpu, const agc_sb_op_t *op) {
+    *op->operand = agc_normalize(cpu->A);
+    agc_memory_mark(cpu, (uint32_t)(op->operand - cpu->erasable));
+}
+
+static void sb_CA(agc_cpu_t *cpu, const agc_sb_op_t *op) {
+    cpu->A = *op->operand;
+}
+
+static void sb_none(agc_cpu_t *cpu, const agc_sb_op_t *op) {
+    (void)cpu; (void)op;
+}
+
+static const agc_sb_fn sb_handlers[8] = {
+    sb_TC, sb_XCH, sb_TS, sb_CA,
+    sb_none, sb_none, sb_none, sb_none,
+};
+
+static inline agc_superblock_t *sb_slot(agc_cpu_t *cpu) {
+    return &cpu->superblocks[(cpu->Z ^ (cpu->FB << 3)) & (AGC_SB_SLOTS - 1)];
+}
+
+/*
+ * Compile the straight-line run starting at Z from the decoded rope.
+ * The run ends after a TC, at the end of the rope, or at AGC_SB_MAX_OPS.
+ * Operand addresses are 10 bits, so all of them resolve into the
+ * erasable bank selected by EB.
+ */
+static void sb_compile(agc_cpu_t *cpu, agc_superblock_t *sb) {
+    agc_word_t pc = cpu->Z;
+    uint8_t len = 0;
+    uint32_t mct = 0;
+    bool ends_in_tc = false;
+    agc_word_t last = 0;
+
+    while (len < AGC_SB_MAX_OPS && pc >= AGC_ERASE_BANK_SIZE) {
+        const agc_decoded_t *page = cpu->decoded_page[(pc >> 10) & 037];
+        if (!page) break;
+
+        const agc_decoded_t *d = &page[pc & 01777];
+        agc_sb_op_t *op = &sb->ops[len++];
+        op->fn = sb_handlers[d->handler];
+        op->operand = &cpu->erasable_bank[d->address & 01777];
+        op->target = agc_normalize(d->address);
+        mct += agc_instr_mct[d->handler];
+        last = d->word;
+
+        if (d->handler == 0) {
+            ends_in_tc = true;
+            break;
+        }
+        if (pc == 077777) break;
+        pc++;
+    }
+
+    sb->start = cpu->Z;
+    sb->bank_key = cpu->bank_key;
+    sb->rope = cpu->rope;
+    sb->rope_gen = cpu->rope->generation;
+    sb->len = len;
+    sb->ends_in_tc = ends_in_tc;
+    sb->last_word = last;
+    sb->mct = mct;
+    sb->heat = 0;
+}
+
+uint64_t agc_sb_run(agc_cpu_t *cpu, uint64_t budget) {
+    agc_memory_sync_banks(cpu);
+
+    agc_superblock_t *sb = sb_slot(cpu);
+
+    // The single entry check: same start, same banks, same rope words
+    if (sb->start != cpu->Z || sb->bank_key != cpu->bank_key || sb->rope != cpu->rope ||
+        sb->rope_gen != cpu->rope->generation) {
+        // Stale or foreign block: start counting visits to this address
+        sb->start = cpu->Z;
+        sb->bank_key = cpu->bank_key;
+        sb->rope = cpu->rope;
+        sb->rope_gen = cpu->rope->generation;
+        sb->len = 0;
+        sb->heat = 1;
+        return 0;
+    }
+
+    if (sb->len == 0) {
+        if (sb->heat == UINT8_MAX || ++sb->heat < AGC_SB_HOT) return 0;
+        sb_compile(cpu, sb);
+        // Single instructions gain nothing from a block; keep them cold
+        if (sb->len < 2) {
+            sb->len = 0;
+            sb->heat = UINT8_MAX;
+            return 0;
+        }
+    }
+
+    // A block runs to its end before events fire: none may fall inside
+    if (sb->len > budget || cpu->cycle_count + sb->mct > cpu->next_event) return 0;
+
+    for (uint8_t i = 0; i < sb->len; i++)
+        sb->ops[i].fn(cpu, &sb->ops[i]);
+
+    if (!sb->ends_in_tc)
+        cpu->Z = agc_normalize(sb->start + sb->len);
+    cpu->current_instruction = sb->last_word;
+    cpu->cycle_count += sb->mct;
+    return sb->len;
+}
+
+void agc_sb_flush(agc_cpu_t *cpu) {
+    memset(cpu->superblocks, 0, sizeof(cpu->superblocks));
+}
+
+#endif // AGC_SUPERBLOCKS
@@ -0,0 +1,72 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "agc_timing.h"
+#include <errno.h>
+
+void agc_pacer_start(agc_pacer_t *pacer, const agc_cpu_t *cpu, double rate) {
+    clock_gettime(CLOCK_MONOTONIC, &pacer->start);
+    pacer->start_mct = cpu->cycle_count;
+    pacer->rate = rate > 0 ? rate : 1.0;
+
+    // Faster than real time, 1 ms of wall time holds more emulated time
+    double slice = pacer->rate * AGC_PACER_SLICE_MCT;
+    if (slice > 1e12) slice = 1e12;
+    pacer->slice_mct = slice > AGC_PACER_SLICE_MCT ? (uint64_t)slice : AGC_PACER_SLICE_MCT;
+}
+
+/*
+ * Sleep until the wall clock catches up with emulated time.
+ * Returns immediately when the emulation is behind.
+ */
+static void pacer_wait(const agc_pacer_t *pacer, uint64_t cycle_count) {
+    double emulated_ns = (double)agc_mct_to_ns(cycle_count - pacer->start_mct) / pacer->rate;
+    uint64_t ns = (uint64_t)emulated_ns;
+
+    struct timespec target = pacer->start;
+    target.tv_sec += (time_t)(ns / 1000000000ULL);
+    target.tv_nsec += (long)(ns % 1000000000ULL);
+    if (target.tv_nsec >= 1000000000L) {
+        target.tv_sec++;
+        target.tv_nsec -= 1000000000L;
+    }
+
+    // Behind schedule: keep running without a sleep syscall
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > target.tv_sec ||
+        (now.tv_sec == target.tv_sec && now.tv_nsec >= target.tv_nsec))
+        return;
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL) == EINTR)
+        ;
+}
+
+/*
+ * Run in slices of slice_mct instructions, pacing between them.
+ * Instructions take one or two MCT, so a slice covers at least slice_mct
+ * of emulated time and at most twice that. The wall clock is read once
+ * per slice, and since each wait targets the actual cycle_count, uneven
+ * slices cost no accuracy.
+ */
+agc_stop_reason_t agc_cpu_run_paced(agc_cpu_t *cpu, agc_pacer_t *pacer,
+                                    uint64_t max_instructions, uint32_t stop_mask,
+                                    uint64_t *executed) {
+    uint64_t per_slice = pacer->slice_mct ? pacer->slice_mct : 1;
+    uint64_t total = 0;
+    agc_stop_reason_t reason = AGC_STOP_COUNT;
+
+    while (total < max_instructions) {
+        uint64_t chunk = max_instructions - total;
+        if (chunk > per_slice) chunk = per_slice;
+
+        uint64_t n;
+        reason = agc_cpu_run(cpu, chunk, stop_mask, &n);
+        total += n;
+
+        pacer_wait(pacer, cpu->cycle_count);
+        if (reason != AGC_STOP_COUNT) break;
+    }
+
+    if (executed) *executed = total;
+    return reason;
+}
@@ -0,0 +1,124 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "agc_trace.h"
+#include "agc_instructions.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+bool agc_trace_init(agc_trace_t *trace, size_t capacity) {
+    // Largest power of two whose ring size still fits in a size_t
+    size_t max = 1;
+    while (max <= SIZE_MAX / sizeof(agc_trace_rec_t) / 2) max <<= 1;
+
+    trace->records = NULL;
+    trace->mask = 0;
+    trace->written = 0;
+    if (capacity > max) return false;
+
+    size_t n = 1;
+    while (n < capacity) n <<= 1;
+
+    trace->records = malloc(n * sizeof(agc_trace_rec_t));
+    trace->mask = trace->records ? n - 1 : 0;
+    trace->written = 0;
+    return trace->records != NULL;
+}
+
+void agc_trace_free(agc_trace_t *trace) {
+    free(trace->records);
+    trace->records = NULL;
+    trace->mask = 0;
+    trace->written = 0;
+}
+
+void agc_trace_reset(agc_trace_t *trace) {
+    trace->written = 0;
+}
+
+void agc_trace_attach(agc_cpu_t *cpu, agc_trace_t *trace) {
+    cpu->trace = trace;
+}
+
+size_t agc_trace_count(const agc_trace_t *trace) {
+    uint64_t capacity = trace->mask + 1;
+    return (size_t)(trace->written < capacity ? trace->written : capacity);
+}
+
+const agc_trace_rec_t *agc_trace_at(const agc_trace_t *trace, size_t i) {
+    uint64_t first = trace->written - agc_trace_count(trace);
+    return &trace->records[(first + i) & trace->mask];
+}
+
+static bool write_all(int fd, const void *buf, size_t size) {
+    const char *p = buf;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n <= 0) return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+/*
+ * Header, then the ring in at most two pieces: from the oldest record to
+ * the end of the buffer, and the wrapped part from its start. Only
+ * write(2) is used, so this may run in a signal handler.
+ */
+bool agc_trace_dump_fd(const agc_trace_t *trace, int fd) {
+    size_t count = agc_trace_count(trace);
+    agc_trace_header_t h = {
+        .magic = AGC_TRACE_MAGIC,
+        .version = AGC_TRACE_VERSION,
+        .record_size = (uint16_t)sizeof(agc_trace_rec_t),
+        .count = count,
+        .dropped = trace->written - count,
+    };
+    if (!write_all(fd, &h, sizeof(h))) return false;
+
+    size_t start = (size_t)((trace->written - count) & trace->mask);
+    size_t first = count < trace->mask + 1 - start ? count : (size_t)(trace->mask + 1 - start);
+    return write_all(fd, &trace->records[start], first * sizeof(agc_trace_rec_t)) &&
+           write_all(fd, trace->records, (count - first) * sizeof(agc_trace_rec_t));
+}
+
+bool agc_trace_dump(const agc_trace_t *trace, const char *path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = agc_trace_dump_fd(trace, fd);
+    return close(fd) == 0 && ok;
+}
+
+bool agc_trace_load(const char *path, agc_trace_header_t *header, agc_trace_rec_t **records) {
+    *records = NULL;
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+
+    bool ok = fread(header, sizeof(*header), 1, f) == 1 &&
+              header->magic == AGC_TRACE_MAGIC &&
+              header->version == AGC_TRACE_VERSION &&
+              header->record_size == sizeof(agc_trace_rec_t) &&
+              header->count <= SIZE_MAX / sizeof(agc_trace_rec_t);
+    if (ok && header->count > 0) {
+        *records = malloc((size_t)header->count * sizeof(agc_trace_rec_t));
+        ok = *records && fread(*records, sizeof(agc_trace_rec_t), (size_t)header->count, f) == header->count;
+        if (!ok) {
+            free(*records);
+            *records = NULL;
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+void agc_trace_format(const agc_trace_rec_t *rec, char *buf, size_t size) {
+    char dis[32];
+    agc_disasm(rec->instr, dis, sizeof(dis));
+    snprintf(buf, size, "%12llu  %c%02o:%04o  %05o  A=%05o  %s",
+             (unsigned long long)rec->cycle, rec->z < AGC_ERASE_BANK_SIZE ? 'E' : 'F',
+             rec->z < AGC_ERASE_BANK_SIZE ? rec->eb : rec->fb, rec->z, rec->instr, rec->a, dis);
+}
@@ -0,0 +1,140 @@
+#include "agc_words.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+// Sum of 16 bytes that are each 0 or 1
+static inline size_t sum_bytes(__m128i bytes) {
+    __m128i sad = _mm_sad_epu8(bytes, _mm_setzero_si128());
+    return (size_t)(_mm_cvtsi128_si32(sad) + _mm_extract_epi16(sad, 4));
+}
+#endif
+
+void agc_add_n(agc_word_t *dst, const agc_word_t *a, const agc_word_t *b, size_t n) {
+    size_t i = 0;
+    // sum fits 16 bits; bit 15 is the end-around carry
+#if defined(__AVX2__)
+    const __m256i mask = _mm256_set1_epi16(AGC_WORD_MASK);
+    for (; i + 16 <= n; i += 16) {
+        __m256i sum = _mm256_add_epi16(_mm256_loadu_si256((const __m256i *)(a + i)),
+                                       _mm256_loadu_si256((const __m256i *)(b + i)));
+        sum = _mm256_add_epi16(_mm256_and_si256(sum, mask), _mm256_srli_epi16(sum, 15));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_and_si256(sum, mask));
+    }
+#elif defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi16(AGC_WORD_MASK);
+    for (; i + 8 <= n; i += 8) {
+        __m128i sum = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(a + i)),
+                                    _mm_loadu_si128((const __m128i *)(b + i)));
+        sum = _mm_add_epi16(_mm_and_si128(sum, mask), _mm_srli_epi16(sum, 15));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_and_si128(sum, mask));
+    }
+#elif defined(__ARM_NEON)
+    const uint16x8_t mask = vdupq_n_u16(AGC_WORD_MASK);
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t sum = vaddq_u16(vld1q_u16(a + i), vld1q_u16(b + i));
+        sum = vaddq_u16(vandq_u16(sum, mask), vshrq_n_u16(sum, 15));
+        vst1q_u16(dst + i, vandq_u16(sum, mask));
+    }
+#endif
+    agc_add_n_scalar(dst + i, a + i, b + i, n - i);
+}
+
+void agc_negate_n(agc_word_t *dst, const agc_word_t *a, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i mask = _mm256_set1_epi16(AGC_WORD_MASK);
+    for (; i + 16 <= n; i += 16)
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                            _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a + i)), mask));
+#elif defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi16(AGC_WORD_MASK);
+    for (; i + 8 <= n; i += 8)
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_xor_si128(_mm_loadu_si128((const __m128i *)(a + i)), mask));
+#elif defined(__ARM_NEON)
+    const uint16x8_t mask = vdupq_n_u16(AGC_WORD_MASK);
+    for (; i + 8 <= n; i += 8)
+        vst1q_u16(dst + i, veorq_u16(vld1q_u16(a + i), mask));
+#endif
+    agc_negate_n_scalar(dst + i, a + i, n - i);
+}
+
+size_t agc_sign_n(uint8_t *neg, const agc_word_t *a, size_t n) {
+    size_t i = 0, count = 0;
+#if defined(__AVX2__)
+    for (; i + 16 <= n; i += 16) {
+        __m256i s = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i *)(a + i)), 14);
+        __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+        _mm_storeu_si128((__m128i *)(neg + i), bytes);
+        count += sum_bytes(bytes);
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        __m128i lo = _mm_srli_epi16(_mm_loadu_si128((const __m128i *)(a + i)), 14);
+        __m128i hi = _mm_srli_epi16(_mm_loadu_si128((const __m128i *)(a + i + 8)), 14);
+        __m128i bytes = _mm_packus_epi16(lo, hi);
+        _mm_storeu_si128((__m128i *)(neg + i), bytes);
+        count += sum_bytes(bytes);
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= n; i += 8) {
+        uint8x8_t bytes = vmovn_u16(vshrq_n_u16(vld1q_u16(a + i), 14));
+        vst1_u8(neg + i, bytes);
+        count += (size_t)vget_lane_u64(vpaddl_u32(vpaddl_u16(vpaddl_u8(bytes))), 0);
+    }
+#endif
+    return count + agc_sign_n_scalar(neg + i, a + i, n - i);
+}
+
+void agc_dp_n(int32_t *dst, const agc_word_t *hi, const agc_word_t *lo, size_t n) {
+    size_t i = 0;
+    // Word value: w for positive words, w - 077777 for negative ones
+#if defined(__AVX2__)
+    const __m256i mask = _mm256_set1_epi16(AGC_WORD_MASK);
+    for (; i + 16 <= n; i += 16) {
+        __m256i h = _mm256_loadu_si256((const __m256i *)(hi + i));
+        __m256i l = _mm256_loadu_si256((const __m256i *)(lo + i));
+        h = _mm256_sub_epi16(h, _mm256_and_si256(_mm256_srai_epi16(_mm256_slli_epi16(h, 1), 15), mask));
+        l = _mm256_sub_epi16(l, _mm256_and_si256(_mm256_srai_epi16(_mm256_slli_epi16(l, 1), 15), mask));
+        for (int half = 0; half < 2; half++) {
+            __m128i h16 = half ? _mm256_extracti128_si256(h, 1) : _mm256_castsi256_si128(h);
+            __m128i l16 = half ? _mm256_extracti128_si256(l, 1) : _mm256_castsi256_si128(l);
+            __m256i v = _mm256_add_epi32(_mm256_slli_epi32(_mm256_cvtepi16_epi32(h16), 14),
+                                         _mm256_cvtepi16_epi32(l16));
+            _mm256_storeu_si256((__m256i *)(dst + i + 8 * half), v);
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi16(AGC_WORD_MASK);
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(hi + i));
+        __m128i l = _mm_loadu_si128((const __m128i *)(lo + i));
+        h = _mm_sub_epi16(h, _mm_and_si128(_mm_srai_epi16(_mm_slli_epi16(h, 1), 15), mask));
+        l = _mm_sub_epi16(l, _mm_and_si128(_mm_srai_epi16(_mm_slli_epi16(l, 1), 15), mask));
+        // Sign-extend to 32 bits by unpacking each word into the high half
+        __m128i h_lo = _mm_srai_epi32(_mm_unpacklo_epi16(h, h), 16);
+        __m128i h_hi = _mm_srai_epi32(_mm_unpackhi_epi16(h, h), 16);
+        __m128i l_lo = _mm_srai_epi32(_mm_unpacklo_epi16(l, l), 16);
+        __m128i l_hi = _mm_srai_epi32(_mm_unpackhi_epi16(l, l), 16);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi32(_mm_slli_epi32(h_lo, 14), l_lo));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_add_epi32(_mm_slli_epi32(h_hi, 14), l_hi));
+    }
+#elif defined(__ARM_NEON)
+    const uint16x8_t mask = vdupq_n_u16(AGC_WORD_MASK);
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t hu = vld1q_u16(hi + i), lu = vld1q_u16(lo + i);
+        int16x8_t h = vreinterpretq_s16_u16(vsubq_u16(hu, vandq_u16(vtstq_u16(hu, vdupq_n_u16(AGC_SIGN_BIT)), mask)));
+        int16x8_t l = vreinterpretq_s16_u16(vsubq_u16(lu, vandq_u16(vtstq_u16(lu, vdupq_n_u16(AGC_SIGN_BIT)), mask)));
+        vst1q_s32(dst + i, vaddq_s32(vshlq_n_s32(vmovl_s16(vget_low_s16(h)), 14), vmovl_s16(vget_low_s16(l))));
+        vst1q_s32(dst + i + 4, vaddq_s32(vshlq_n_s32(vmovl_s16(vget_high_s16(h)), 14), vmovl_s16(vget_high_s16(l))));
+    }
+#endif
+    agc_dp_n_scalar(dst + i, hi + i, lo + i, n - i);
+}
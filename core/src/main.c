@@ -1,24 +1,68 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <ctype.h>
 #include <stdarg.h>
+#include <time.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "agc_cpu.h"
 #include "agc_memory.h"
 #include "agc_instructions.h"
+#include "agc_journal.h"
+#include "agc_rope.h"
+#include "agc_profiler.h"
+#include "agc_debug.h"
+#include "agc_trace.h"
+#include "agc_corefile.h"
+
+/* ANSI colors, empty when colors are off (batch mode) */
+static bool use_color = true;
+
+#define CLR(code)   (use_color ? "\033[" code "m" : "")
+#define CLR_RESET   CLR("0")
+#define CLR_PROMPT  CLR("1;36")
+#define CLR_INFO    CLR("1;32")
+#define CLR_ERROR   CLR("1;31")
+#define CLR_HEADER  CLR("1;35")
+#define CLR_ADDR    CLR("1;36")
+#define CLR_DATA    CLR("1;32")
+#define CLR_ZERO    CLR("1;30")
+#define CLR_NONZERO CLR("1;33")
+#define CLR_PC      CLR("1;34")
+
+/* Input journal; records while a "record" is active */
+static agc_journal_t journal;
+
+/* Rope image held from the registry by the "rom" command */
+static const agc_rope_t *rom_image;
+
+/* Counters for the "prof" command */
+static agc_prof_t profile;
+
+/* Points set by the "break" and "watch" commands */
+static agc_debug_t debug_map;
 
-/* ANSI colors */
-#define CLR_RESET   "\033[0m"
-#define CLR_PROMPT  "\033[1;36m"
-#define CLR_INFO    "\033[1;32m"
-#define CLR_ERROR   "\033[1;31m"
-#define CLR_HEADER  "\033[1;35m"
-#define CLR_ADDR    "\033[1;36m"
-#define CLR_DATA    "\033[1;32m"
-#define CLR_ZERO    "\033[1;30m"
-#define CLR_NONZERO "\033[1;33m"
-#define CLR_PC      "\033[1;34m"
+/* Ring for the "trace" command; dumped to FAULT_TRACE_PATH on a crash */
+#define FAULT_TRACE_PATH "agc_fault.trace"
+#define TRACE_MAX_RECORDS (1L << 26)
+static agc_trace_t trace_ring;
+static volatile sig_atomic_t tracing;
+
+/* Core file backing erasable memory ("core" command, --core) */
+static agc_corefile_t core_file;
+static char core_path[256];
+static const char *startup_core;
+
+/* Batch mode (--batch): script position for messages, failed "expect"s */
+static bool batch_mode;
+static const char *script_name;
+static unsigned long script_line;
+static unsigned long expect_failures;
 
 /* Helper: skip whitespace in string */
 static const char *skip_ws(const char *s) {
@@ -26,18 +70,30 @@ static const char *skip_ws(const char *s) {
     return s;
 }
 
-/* Helper: parse octal number from string, returns -1 on error */
-static int parse_octal(const char *s) {
-    if (!s || !*s) return -1;
+/* Helper: parse the octal number at s, ending at whitespace or the end of
+ * the string; *end gets the position after it. Returns -1 on error.
+ * Works in place, so arguments are never copied out of the line. */
+static int parse_octal_word(const char *s, const char **end) {
+    const char *p = s;
     int result = 0;
-    while (*s) {
-        if (*s < '0' || *s > '7') return -1;
-        result = (result << 3) | (*s - '0');
-        s++;
+    while (*p >= '0' && *p <= '7') {
+        if (result > 07777777) return -1;
+        result = (result << 3) | (*p - '0');
+        p++;
     }
+    if (p == s || (*p && !isspace((unsigned char)*p))) return -1;
+    *end = p;
     return result;
 }
 
+/* Helper: parse octal number from string, returns -1 on error */
+static int parse_octal(const char *s) {
+    if (!s) return -1;
+    const char *end;
+    int result = parse_octal_word(s, &end);
+    return (result >= 0 && *end == '\0') ? result : -1;
+}
+
 /* Helper: parse positive long from string, returns false on error */
 static bool parse_positive_long(const char *s, long *out) {
     if (!s || !*s) return false;
@@ -64,45 +120,13 @@ static bool parse_single_octal_arg(const char *args, int *out, const char *cmd_n
 
 /* Helper: parse two octal arguments */
 static bool parse_two_octal_args(const char *args, int *a, int *b, const char *cmd_name) {
-    /* Skip leading whitespace and parse first octal number */
-    const char *p = skip_ws(args);
-    const char *first_start = p;
-    while (*p >= '0' && *p <= '7') p++;
-    const char *first_end = p;
-    int first_len = first_end - first_start;
-    if (first_len == 0) {
-        print_usage(cmd_name);
-        return false;
-    }
-
-    /* Skip whitespace between arguments */
-    p = skip_ws(p);
-    if (!*p) {
-        print_usage(cmd_name);
-        return false;
-    }
-
-    /* Parse second octal number directly without copying */
-    int second = parse_octal(p);
+    const char *p;
+    int first = parse_octal_word(skip_ws(args), &p);
+    int second = first < 0 ? -1 : parse_octal(skip_ws(p));
     if (second < 0) {
         print_usage(cmd_name);
         return false;
     }
-
-    /* Parse first octal number directly without copying */
-    char first_buf[16];
-    if (first_len >= (int)sizeof(first_buf)) {
-        print_usage(cmd_name);
-        return false;
-    }
-    memcpy(first_buf, first_start, first_len);
-    first_buf[first_len] = '\0';
-    int first = parse_octal(first_buf);
-
-    if (first < 0) {
-        print_usage(cmd_name);
-        return false;
-    }
     *a = first;
     *b = second;
     return true;
@@ -110,8 +134,9 @@ static bool parse_two_octal_args(const char *args, int *a, int *b, const char *c
 
 /* Helper: parse non-negative long argument */
 static bool parse_non_negative_long(const char *args, long *out, const char *cmd_name) {
-    long v;
-    if (!parse_positive_long(args, &v) || v < 0) {
+    char *endptr;
+    long v = args ? strtol(args, &endptr, 10) : -1;
+    if (!args || endptr == args || v < 0) {
         print_usage(cmd_name);
         return false;
     }
@@ -134,43 +159,21 @@ static void split_command(char *line, char **cmd, char **args) {
 /* Helper: print colored tag with format */
 static void print_colored(const char *tag, const char *color, const char *fmt, ...) {
     va_list ap;
-    printf("%s%s" CLR_RESET ": ", color, tag);
+    printf("%s%s%s: ", color, tag, CLR_RESET);
     va_start(ap, fmt);
     vprintf(fmt, ap);
     va_end(ap);
     printf("\n");
 }
 
-/* Minimal AGC disassembler for core opcodes */
-static void disasm_word(agc_word_t instr, char *buf, size_t buf_size) {
-    unsigned int opcode = (instr >> 12) & 07;   /* top 3 bits */
-    unsigned int addr   = instr & 07777;        /* 12-bit address */
-
-    const char *mnemonic = "???";
-
-    switch (opcode) {
-        case 0: mnemonic = "TC";    break;
-        case 1: mnemonic = "XCH";   break;
-        case 2: mnemonic = "TS";    break;
-        case 3: mnemonic = "CA";    break;
-        case 4: mnemonic = "CCS";   break;
-        case 5: mnemonic = "INDEX"; break;
-        case 6: mnemonic = "ADS";   break;
-        case 7: mnemonic = "BUSY";  break;
-        default: mnemonic = "???";  break;
-    }
-
-    snprintf(buf, buf_size, "%s %04o", mnemonic, addr);
-}
-
 static void dump_cpu(const agc_cpu_t *cpu) {
-    printf(CLR_HEADER "\n=== AGC CPU STATE ===\n" CLR_RESET);
-    printf(CLR_INFO "EB: %d, FB: %d\n" CLR_RESET, cpu->EB, cpu->FB);
+    printf("%s\n=== AGC CPU STATE ===\n%s", CLR_HEADER, CLR_RESET);
+    printf("%sEB: %d, FB: %d\n%s", CLR_INFO, cpu->EB, cpu->FB, CLR_RESET);
     printf("A: %04o\n", cpu->A);
     printf("L: %04o\n", cpu->L);
     printf("Q: %04o\n", cpu->Q);
     printf("Z: %04o\n", cpu->Z);
-    printf(CLR_HEADER "=====================\n\n" CLR_RESET);
+    printf("%s=====================\n\n%s", CLR_HEADER, CLR_RESET);
 }
 
 /* Command function typedef */
@@ -190,9 +193,38 @@ static bool cmd_dump(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
     return true;
 }
 
+/* Helper: name a physical word as E<bank>:<addr> or F<bank>:<addr> */
+static void format_phys(uint32_t phys, char *buf, size_t size) {
+    if (phys < AGC_RAM_SIZE) {
+        snprintf(buf, size, "E%d:%04o", (int)(phys / AGC_ERASE_BANK_SIZE),
+                 (unsigned)(phys % AGC_ERASE_BANK_SIZE));
+    } else {
+        phys -= AGC_RAM_SIZE;
+        snprintf(buf, size, "F%02d:%04o", (int)(phys / AGC_FIXED_BANK_SIZE),
+                 (unsigned)(AGC_ERASE_BANK_SIZE + phys % AGC_FIXED_BANK_SIZE));
+    }
+}
+
+/* Helper: print the breakpoint/watchpoint hit latched in the CPU, if any */
+static bool report_hit(const agc_cpu_t *cpu) {
+    if (!cpu->debug_hit)
+        return false;
+    char where[16];
+    format_phys(cpu->debug_hit_phys, where, sizeof(where));
+    uint8_t rw = cpu->debug_hit & (AGC_DEBUG_READ | AGC_DEBUG_WRITE);
+    const char *what = (cpu->debug_hit & AGC_DEBUG_EXEC) ? "Breakpoint" :
+                       rw == (AGC_DEBUG_READ | AGC_DEBUG_WRITE) ? "Read/write watchpoint" :
+                       rw == AGC_DEBUG_READ ? "Read watchpoint" : "Write watchpoint";
+    printf("%s%s hit at %s%s (Z=%04o, cycle %llu)\n", CLR_INFO, what, where, CLR_RESET, cpu->Z,
+           (unsigned long long)cpu->cycle_count);
+    return true;
+}
+
 static bool cmd_step(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
     (void)args; (void)rom_loaded;
+    cpu->debug_hit = 0;
     agc_cpu_step(cpu);
+    report_hit(cpu);
     return true;
 }
 
@@ -203,13 +235,185 @@ static bool cmd_run(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
         print_usage("run");
         return false;
     }
+    cpu->debug_hit = 0;
     for (long i = 0; i < n; ++i) {
-        agc_word_t instr = agc_memory_read(cpu, cpu->Z);
+        // Fetch through the bank cache so watchpoints do not see it
+        agc_memory_sync_banks(cpu);
+        agc_word_t instr = agc_memory_read_banked(cpu, cpu->Z);
         char dis[32];
-        disasm_word(instr, dis, sizeof(dis));
+        agc_disasm(instr, dis, sizeof(dis));
         printf("PC %04o: %04o  (%s)\n", cpu->Z, instr, dis);
         agc_cpu_step(cpu);
+        if (report_hit(cpu))
+            break;
+    }
+    return true;
+}
+
+static const char *stop_reason_name(agc_stop_reason_t reason) {
+    switch (reason) {
+        case AGC_STOP_COUNT:      return "count reached";
+        case AGC_STOP_BREAKPOINT: return "breakpoint";
+        case AGC_STOP_Z_RANGE:    return "Z in range";
+        case AGC_STOP_IO_WRITE:   return "I/O channel write";
+        case AGC_STOP_CYCLE:      return "cycle reached";
+        case AGC_STOP_WATCH:      return "watchpoint";
+        case AGC_STOP_RUPT:       return "interrupt request";
+        default:                  return "none";
+    }
+}
+
+static double elapsed_sec(const struct timespec *start, const struct timespec *end) {
+    return (double)(end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+static bool cmd_qrun(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    long n;
+    if (!parse_positive_long(args, &n)) {
+        print_usage("qrun");
+        return false;
+    }
+
+    struct timespec start, end;
+    uint64_t executed;
+    timespec_get(&start, TIME_UTC);
+    agc_stop_reason_t reason = agc_cpu_run(cpu, (uint64_t)n, AGC_STOP_BREAKPOINT | AGC_STOP_WATCH,
+                                           &executed);
+    timespec_get(&end, TIME_UTC);
+
+    double secs = elapsed_sec(&start, &end);
+    printf("Ran %llu instructions in %.3f s (%.0f instr/s), stopped: %s, Z=%04o\n",
+           (unsigned long long)executed, secs, secs > 0 ? executed / secs : 0.0,
+           stop_reason_name(reason), cpu->Z);
+    report_hit(cpu);
+    return true;
+}
+
+/* Helper: parse "<octal addr> [bank]"; the bank defaults to the current EB or FB */
+static bool parse_point(const agc_cpu_t *cpu, const char *args, agc_word_t *addr, uint8_t *bank) {
+    char a[16], b[16];
+    int n = sscanf(args, "%15s %15s", a, b);
+    int v = n >= 1 ? parse_octal(a) : -1;
+    if (v < 0 || v > 077777)
+        return false;
+    *addr = (agc_word_t)v;
+    *bank = v < AGC_ERASE_BANK_SIZE ? cpu->EB : cpu->FB;
+    if (n == 2) {
+        char *end;
+        long k = strtol(b, &end, 10);
+        if (*end || k < 0 || k > 255)
+            return false;
+        *bank = (uint8_t)k;
+    }
+    return true;
+}
+
+/* Helper: list the points of one kind */
+static void list_points(agc_debug_kind_t kind, const char *title) {
+    uint32_t phys[64];
+    size_t n = agc_debug_list(&debug_map, kind, phys, 64);
+    printf("%s%s:%s\n%s", CLR_HEADER, title, n ? "" : " none", CLR_RESET);
+    for (size_t i = 0; i < n; i++) {
+        char where[16];
+        format_phys(phys[i], where, sizeof(where));
+        printf("  %s\n", where);
+    }
+    if (n == 64)
+        printf("  ...\n");
+}
+
+static bool cmd_break(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    char sub[16] = "";
+    int used = 0;
+    sscanf(args, "%15s%n", sub, &used);
+    if (cpu->debug != &debug_map)
+        agc_debug_attach(cpu, &debug_map);
+
+    if (!sub[0]) {
+        list_points(AGC_DEBUG_EXEC, "Breakpoints");
+        return true;
+    }
+    if (strcmp(sub, "clear") == 0) {
+        agc_debug_clear(cpu, AGC_DEBUG_EXEC);
+        printf("Breakpoints cleared\n");
+        return true;
+    }
+
+    bool on = strcmp(sub, "del") != 0;
+    agc_word_t addr;
+    uint8_t bank;
+    if (!parse_point(cpu, on ? args : args + used, &addr, &bank)) {
+        print_usage("break");
+        return false;
+    }
+    agc_debug_set(cpu, AGC_DEBUG_EXEC, bank, addr, on);
+
+    char where[16];
+    format_phys(agc_phys_index(bank, bank, addr), where, sizeof(where));
+    printf("Breakpoint %s at %s\n", on ? "set" : "removed", where);
+    return true;
+}
+
+static bool cmd_watch(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    char sub[16] = "";
+    int used = 0;
+    sscanf(args, "%15s%n", sub, &used);
+    if (cpu->debug != &debug_map)
+        agc_debug_attach(cpu, &debug_map);
+
+    if (!sub[0]) {
+        list_points(AGC_DEBUG_READ, "Read watchpoints");
+        list_points(AGC_DEBUG_WRITE, "Write watchpoints");
+        return true;
+    }
+    if (strcmp(sub, "clear") == 0) {
+        agc_debug_clear(cpu, AGC_DEBUG_READ | AGC_DEBUG_WRITE);
+        printf("Watchpoints cleared\n");
+        return true;
+    }
+
+    unsigned kinds;
+    bool on = true;
+    if (strcmp(sub, "r") == 0)        kinds = AGC_DEBUG_READ;
+    else if (strcmp(sub, "w") == 0)   kinds = AGC_DEBUG_WRITE;
+    else if (strcmp(sub, "rw") == 0)  kinds = AGC_DEBUG_READ | AGC_DEBUG_WRITE;
+    else if (strcmp(sub, "del") == 0) kinds = AGC_DEBUG_READ | AGC_DEBUG_WRITE, on = false;
+    else {
+        print_usage("watch");
+        return false;
+    }
+
+    agc_word_t addr;
+    uint8_t bank;
+    if (!parse_point(cpu, args + used, &addr, &bank)) {
+        print_usage("watch");
+        return false;
+    }
+    agc_debug_set(cpu, kinds, bank, addr, on);
+
+    char where[16];
+    format_phys(agc_phys_index(bank, bank, addr), where, sizeof(where));
+    printf("Watchpoint %s at %s\n", on ? "set" : "removed", where);
+    return true;
+}
+
+static bool cmd_continue(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    long n = 100000000;
+    if (*skip_ws(args) && !parse_positive_long(args, &n)) {
+        print_usage("continue");
+        return false;
     }
+
+    uint64_t executed;
+    agc_stop_reason_t reason = agc_cpu_run(cpu, (uint64_t)n, AGC_STOP_BREAKPOINT | AGC_STOP_WATCH,
+                                           &executed);
+    printf("Ran %llu instructions, stopped: %s, Z=%04o\n",
+           (unsigned long long)executed, stop_reason_name(reason), cpu->Z);
+    report_hit(cpu);
     return true;
 }
 
@@ -219,7 +423,7 @@ static bool cmd_load(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
     if (!parse_two_octal_args(args, &addr, &value, "load"))
         return false;
 
-    agc_memory_write(cpu, (agc_word_t)addr, (agc_word_t)value);
+    agc_journal_input(&journal, cpu, AGC_JOURNAL_POKE, (agc_word_t)addr, (agc_word_t)value);
     printf("Loaded %04o into %04o (EB:%d FB:%d)\n", value, addr, cpu->EB, cpu->FB);
     return true;
 }
@@ -232,7 +436,7 @@ static bool cmd_dis(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
 
     agc_word_t instr = agc_memory_read(cpu, (agc_word_t)addr);
     char dis[32];
-    disasm_word(instr, dis, sizeof(dis));
+    agc_disasm(instr, dis, sizeof(dis));
     printf("(%d:%04o) %04o  %s\n", (addr < 02000) ? cpu->EB : cpu->FB, addr, instr, dis);
     return true;
 }
@@ -242,7 +446,7 @@ static bool cmd_eb(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
     long b;
     if (!parse_non_negative_long(args, &b, "eb"))
         return false;
-    cpu->EB = (uint8_t)b;
+    agc_journal_input(&journal, cpu, AGC_JOURNAL_EB, 0, (agc_word_t)(uint8_t)b);
     printf("Switched to erasable bank %d\n", cpu->EB);
     return true;
 }
@@ -252,7 +456,7 @@ static bool cmd_fb(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
     long b;
     if (!parse_non_negative_long(args, &b, "fb"))
         return false;
-    cpu->FB = (uint8_t)b;
+    agc_journal_input(&journal, cpu, AGC_JOURNAL_FB, 0, (agc_word_t)(uint8_t)b);
     printf("Switched to fixed bank %d\n", cpu->FB);
     return true;
 }
@@ -262,8 +466,8 @@ static bool cmd_bank(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
     long b;
     if (!parse_non_negative_long(args, &b, "bank"))
         return false;
-    cpu->EB = (uint8_t)b;
-    cpu->FB = (uint8_t)b;
+    agc_journal_input(&journal, cpu, AGC_JOURNAL_EB, 0, (agc_word_t)(uint8_t)b);
+    agc_journal_input(&journal, cpu, AGC_JOURNAL_FB, 0, (agc_word_t)(uint8_t)b);
     printf("Switched to bank %ld (EB=%d FB=%d)\n", b, cpu->EB, cpu->FB);
     return true;
 }
@@ -283,7 +487,7 @@ static bool cmd_poke(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
     int addr, value;
     if (!parse_two_octal_args(args, &addr, &value, "poke"))
         return false;
-    agc_memory_write(cpu, (agc_word_t)addr, (agc_word_t)value);
+    agc_journal_input(&journal, cpu, AGC_JOURNAL_POKE, (agc_word_t)addr, (agc_word_t)value);
     printf("Wrote %04o into %04o (EB:%d FB:%d)\n", value, addr, cpu->EB, cpu->FB);
     return true;
 }
@@ -302,7 +506,7 @@ static bool cmd_mem(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
 
     int addr = start;
     while (addr <= end) {
-        printf(CLR_ADDR "%04o" CLR_RESET ": ", addr);
+        printf("%s%04o%s: ", CLR_ADDR, addr, CLR_RESET);
 
         for (int i = 0; i < 8 && addr <= end; ++i, ++addr) {
             agc_word_t v = agc_memory_read(cpu, (agc_word_t)addr);
@@ -312,7 +516,7 @@ static bool cmd_mem(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
                 color = CLR_PC;
             }
 
-            printf("%s%04o" CLR_RESET " ", color, v);
+            printf("%s%04o%s ", color, v, CLR_RESET);
         }
         printf("\n");
     }
@@ -321,14 +525,22 @@ static bool cmd_mem(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
 }
 
 static bool cmd_rom(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
-    (void)cpu;
     char filename[128];
     if (sscanf(args, "%127s", filename) != 1) {
         print_colored("Usage", CLR_ERROR, "rom <filename>");
         return false;
     }
-    if (agc_load_rom(filename)) {
-        printf("ROM loaded from %s\n", filename);
+    agc_rope_info_t info;
+    const agc_rope_t *rope = agc_rope_acquire(filename, &info);
+    if (rope) {
+        agc_memory_attach_rope(cpu, rope);
+        agc_rope_release(rom_image);
+        rom_image = rope;
+        printf("ROM loaded from %s (%s, %zu bytes, %zu words, checksum %016llx)\n",
+               filename, agc_rope_format_name(info.format), info.file_size, info.words,
+               (unsigned long long)info.checksum);
+        if (info.words < AGC_ROM_SIZE)
+            printf("Warning: short image, words %zu-%d are zero\n", info.words, AGC_ROM_SIZE - 1);
         *rom_loaded = true;
     } else {
         printf("Failed to load ROM from %s\n", filename);
@@ -337,6 +549,288 @@ static bool cmd_rom(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
     return true;
 }
 
+static bool cmd_in(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    int channel, value;
+    if (!parse_two_octal_args(args, &channel, &value, "in"))
+        return false;
+    agc_journal_input(&journal, cpu, AGC_JOURNAL_IN, (agc_word_t)(channel & 15), (agc_word_t)value);
+    printf("IN[%d] = %04o\n", channel & 15, cpu->IN[channel & 15]);
+    return true;
+}
+
+static bool cmd_record(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)args; (void)rom_loaded;
+    agc_journal_begin(&journal, cpu);
+    printf("Recording inputs from cycle %llu\n", (unsigned long long)cpu->cycle_count);
+    return true;
+}
+
+static bool cmd_endrec(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    char filename[128];
+    if (sscanf(args, "%127s", filename) != 1) {
+        print_usage("endrec");
+        return false;
+    }
+    if (!journal.recording) {
+        print_colored("Error", CLR_ERROR, "not recording");
+        return true;
+    }
+    agc_journal_end(&journal, cpu);
+    if (!agc_journal_save(&journal, filename)) {
+        printf("Failed to write journal to %s\n", filename);
+        return false;
+    }
+    printf("Journal with %zu inputs written to %s\n", journal.count, filename);
+    return true;
+}
+
+static bool cmd_replay(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    char filename[128];
+    if (sscanf(args, "%127s", filename) != 1) {
+        print_usage("replay");
+        return false;
+    }
+    agc_journal_t replay;
+    agc_journal_init(&replay);
+    if (!agc_journal_load(&replay, filename)) {
+        printf("Failed to load journal from %s\n", filename);
+        return false;
+    }
+    bool ok = agc_journal_replay(&replay, cpu);
+    printf("Replayed %zu inputs to cycle %llu%s\n", replay.count,
+           (unsigned long long)cpu->cycle_count, ok ? "" : " (diverged)");
+    agc_journal_free(&replay);
+    return true;
+}
+
+static bool cmd_prof(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    char sub[16] = "top", arg[128] = "";
+    sscanf(args, "%15s %127s", sub, arg);
+
+    if (strcmp(sub, "on") == 0) {
+        if (!agc_prof_attach(cpu, &profile)) {
+            print_colored("Error", CLR_ERROR, "profiler not built (configure with -DAGC_PROFILER=ON)");
+            return true;
+        }
+        printf("Profiling on\n");
+    } else if (strcmp(sub, "off") == 0) {
+        agc_prof_attach(cpu, NULL);
+        printf("Profiling off\n");
+    } else if (strcmp(sub, "reset") == 0) {
+        agc_prof_reset(&profile);
+        printf("Profile cleared\n");
+    } else if (strcmp(sub, "export") == 0) {
+        if (!arg[0]) {
+            print_usage("prof");
+            return false;
+        }
+        if (!agc_prof_export(&profile, arg)) {
+            printf("Failed to write profile to %s\n", arg);
+            return false;
+        }
+        printf("Profile written to %s\n", arg);
+    } else if (strcmp(sub, "top") == 0) {
+        agc_prof_hot_t hot[64];
+        long n = arg[0] ? strtol(arg, NULL, 10) : 10;
+        if (n < 1) n = 1;
+        if (n > 64) n = 64;
+        size_t found = agc_prof_hottest(&profile, cpu, hot, (size_t)n);
+
+        printf("%s%llu instructions, EB switches %llu, FB switches %llu\n%s", CLR_HEADER,
+               (unsigned long long)profile.instructions,
+               (unsigned long long)profile.eb_switches, (unsigned long long)profile.fb_switches,
+               CLR_RESET);
+        for (int op = 0; op < 8; op++) {
+            if (!profile.opcode[op]) continue;
+            printf("  %-6s %12llu\n", agc_instr_names[op], (unsigned long long)profile.opcode[op]);
+        }
+        for (size_t i = 0; i < found; i++) {
+            char dis[32];
+            agc_disasm(hot[i].word, dis, sizeof(dis));
+            double pct = profile.instructions ? 100.0 * (double)hot[i].count / (double)profile.instructions : 0.0;
+            printf("  %c%02o %s%04o%s  %12llu  %5.1f%%  %04o  %s\n",
+                   hot[i].fixed ? 'F' : 'E', hot[i].bank, CLR_ADDR, hot[i].addr, CLR_RESET,
+                   (unsigned long long)hot[i].count, pct, hot[i].word, dis);
+        }
+    } else {
+        print_usage("prof");
+        return false;
+    }
+    return true;
+}
+
+static bool cmd_trace(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    char sub[16] = "", arg[128] = "";
+    sscanf(args, "%15s %127s", sub, arg);
+
+    if (!sub[0]) {
+        printf("Tracing %s, %zu records held (%llu written)\n", tracing ? "on" : "off",
+               trace_ring.records ? agc_trace_count(&trace_ring) : 0,
+               (unsigned long long)trace_ring.written);
+    } else if (strcmp(sub, "on") == 0) {
+        long n = 65536;
+        if (arg[0] && !parse_positive_long(arg, &n)) {
+            print_usage("trace");
+            return false;
+        }
+        if (n > TRACE_MAX_RECORDS) {
+            print_colored("Error", CLR_ERROR, "at most %ld trace records", TRACE_MAX_RECORDS);
+            return false;
+        }
+        tracing = 0;
+        agc_trace_attach(cpu, NULL);
+        agc_trace_free(&trace_ring);
+        if (!agc_trace_init(&trace_ring, (size_t)n)) {
+            print_colored("Error", CLR_ERROR, "cannot allocate %ld trace records", n);
+            return true;
+        }
+        agc_trace_attach(cpu, &trace_ring);
+        tracing = 1;
+        printf("Tracing on, last %llu instructions kept\n", (unsigned long long)trace_ring.mask + 1);
+    } else if (strcmp(sub, "off") == 0) {
+        agc_trace_attach(cpu, NULL);
+        tracing = 0;
+        printf("Tracing off\n");
+    } else if (strcmp(sub, "dump") == 0) {
+        if (!arg[0]) {
+            print_usage("trace");
+            return false;
+        }
+        if (!trace_ring.records || !agc_trace_dump(&trace_ring, arg)) {
+            printf("Failed to write trace to %s\n", arg);
+            return false;
+        }
+        printf("%zu records written to %s\n", agc_trace_count(&trace_ring), arg);
+    } else if (strcmp(sub, "show") == 0) {
+        long n = 20;
+        if (arg[0] && !parse_positive_long(arg, &n)) {
+            print_usage("trace");
+            return false;
+        }
+        size_t count = trace_ring.records ? agc_trace_count(&trace_ring) : 0;
+        size_t first = (size_t)n < count ? count - (size_t)n : 0;
+        for (size_t i = first; i < count; i++) {
+            char line[96];
+            agc_trace_format(agc_trace_at(&trace_ring, i), line, sizeof(line));
+            printf("%s\n", line);
+        }
+    } else {
+        print_usage("trace");
+        return false;
+    }
+    return true;
+}
+
+/* Helper: back erasable memory with the core file at path, replacing
+ * any open one; the instance keeps its contents if that fails */
+static bool attach_core(agc_cpu_t *cpu, const char *path) {
+    agc_corefile_t next;
+    if (!agc_corefile_open(&next, path)) {
+        print_colored("Error", CLR_ERROR, "cannot map %s as a core file", path);
+        return false;
+    }
+    agc_corefile_close(&core_file);
+    core_file = next;
+    agc_corefile_attach(cpu, &core_file);
+    snprintf(core_path, sizeof(core_path), "%s", path);
+    printf("Erasable memory in %s (%s)\n", core_path, core_file.created ? "new" : "resumed");
+    return true;
+}
+
+static bool cmd_core(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    char arg[128] = "";
+    sscanf(args, "%127s", arg);
+
+    if (!arg[0]) {
+        if (core_file.base)
+            printf("Erasable memory in %s\n", core_path);
+        else
+            printf("Erasable memory not persistent\n");
+    } else if (strcmp(arg, "off") == 0) {
+        /* The instance keeps a copy; the file keeps its last contents */
+        agc_corefile_close(&core_file);
+        printf("Erasable memory not persistent\n");
+    } else {
+        return attach_core(cpu, arg);
+    }
+    return true;
+}
+
+static bool cmd_msync(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)cpu; (void)args; (void)rom_loaded;
+    if (!core_file.base) {
+        print_colored("Error", CLR_ERROR, "no core file, see \"core <file>\"");
+        return false;
+    }
+    if (!agc_corefile_sync(&core_file)) {
+        print_colored("Error", CLR_ERROR, "msync of %s failed", core_path);
+        return false;
+    }
+    printf("Checkpoint written to %s\n", core_path);
+    return true;
+}
+
+/* Helper: value named by an "expect" operand: a register, IN<ch>/OUT<ch>
+ * (octal channel) or an octal address read under the current banks */
+static bool expect_operand(agc_cpu_t *cpu, const char *name, size_t len, int *value) {
+#define NAME_IS(s) (len == sizeof(s) - 1 && memcmp(name, s, len) == 0)
+    const char *end;
+    int n;
+    if (NAME_IS("A"))       *value = cpu->A;
+    else if (NAME_IS("L"))  *value = cpu->L;
+    else if (NAME_IS("Q"))  *value = cpu->Q;
+    else if (NAME_IS("Z"))  *value = cpu->Z;
+    else if (NAME_IS("EB")) *value = cpu->EB;
+    else if (NAME_IS("FB")) *value = cpu->FB;
+    else if (NAME_IS("BB")) *value = cpu->BB;
+    else if (len > 2 && memcmp(name, "IN", 2) == 0 &&
+             (n = parse_octal_word(name + 2, &end)) >= 0 && end == name + len && n < 16)
+        *value = cpu->IN[n];
+    else if (len > 3 && memcmp(name, "OUT", 3) == 0 &&
+             (n = parse_octal_word(name + 3, &end)) >= 0 && end == name + len && n < 16)
+        *value = cpu->OUT[n];
+    else if ((n = parse_octal_word(name, &end)) >= 0 && end == name + len && n <= 077777) {
+        /* Through the bank cache so watchpoints do not see it */
+        agc_memory_sync_banks(cpu);
+        *value = agc_memory_read_banked(cpu, (agc_word_t)n);
+    } else
+        return false;
+    return true;
+#undef NAME_IS
+}
+
+static bool cmd_expect(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
+    (void)rom_loaded;
+    const char *name = skip_ws(args), *p = name;
+    while (*p && !isspace((unsigned char)*p)) p++;
+    size_t len = (size_t)(p - name);
+
+    int want = parse_octal(skip_ws(p)), got;
+    if (want < 0 || !expect_operand(cpu, name, len, &got)) {
+        print_usage("expect");
+        return false;
+    }
+
+    if (got != want) {
+        expect_failures++;
+        if (batch_mode)
+            printf("FAIL %s:%lu: expect %.*s %o, got %o\n", script_name, script_line,
+                   (int)len, name, (unsigned)want, (unsigned)got);
+        else
+            print_colored("FAIL", CLR_ERROR, "%.*s is %o, expected %o", (int)len, name,
+                          (unsigned)got, (unsigned)want);
+    } else if (!batch_mode) {
+        print_colored("OK", CLR_INFO, "%.*s is %o", (int)len, name, (unsigned)got);
+    }
+    return true;
+}
+
 static bool cmd_quit(agc_cpu_t *cpu, const char *args, bool *rom_loaded) {
     (void)cpu; (void)args; (void)rom_loaded;
     return false;  /* signal to exit */
@@ -347,6 +841,7 @@ static const repl_command_t commands[] = {
     { "dump", "dump                       - show CPU registers", cmd_dump },
     { "step", "step                      - execute one instruction", cmd_step },
     { "run",  "run <positive_number>     - execute n instructions", cmd_run },
+    { "qrun", "qrun <positive_number>    - run n instructions quietly, print summary", cmd_qrun },
     { "load", "load <addr> <octal_value> - write instruction/data", cmd_load },
     { "dis",  "dis <addr>                - disassemble word at addr", cmd_dis },
     { "eb",   "eb <n>                    - set erasable bank (EB)", cmd_eb },
@@ -356,6 +851,18 @@ static const repl_command_t commands[] = {
     { "poke", "poke <addr> <val>         - write val to addr", cmd_poke },
     { "mem",  "mem <start> <end>         - dump memory range", cmd_mem },
     { "rom",  "rom <filename>            - load ROM binary", cmd_rom },
+    { "in",   "in <chan> <val>           - write input channel", cmd_in },
+    { "record", "record                    - start journaling inputs", cmd_record },
+    { "endrec", "endrec <filename>         - stop journaling, save journal", cmd_endrec },
+    { "replay", "replay <filename>         - replay a journal from its start", cmd_replay },
+    { "prof", "prof [on|off|reset|top [n]|export <file>] - execution profile", cmd_prof },
+    { "break", "break [<addr> [bank] | del <addr> [bank] | clear] - execution breakpoints", cmd_break },
+    { "watch", "watch [r|w|rw|del <addr> [bank] | clear] - memory watchpoints", cmd_watch },
+    { "continue", "continue [n]              - run until a breakpoint/watchpoint (at most n)", cmd_continue },
+    { "trace", "trace [on [n]|off|show [n]|dump <file>] - binary instruction trace", cmd_trace },
+    { "core", "core [<file>|off]          - keep erasable memory in a mapped file", cmd_core },
+    { "msync", "msync                     - checkpoint the core file to disk", cmd_msync },
+    { "expect", "expect <reg|INn|OUTn|addr> <octal> - assert a value (batch exit status)", cmd_expect },
     { "quit", "quit                      - exit emulator", cmd_quit },
 };
 
@@ -370,9 +877,9 @@ static void print_usage(const char *cmd) {
         }
     }
     /* Print all commands */
-    printf(CLR_HEADER "Available commands:\n" CLR_RESET);
+    printf("%sAvailable commands:\n%s", CLR_HEADER, CLR_RESET);
     for (size_t i = 0; i < sizeof(commands)/sizeof(commands[0]); i++) {
-        printf("  " CLR_INFO "%s\n" CLR_RESET, commands[i].usage);
+        printf("  %s%s\n%s", CLR_INFO, commands[i].usage, CLR_RESET);
     }
     printf("\n");
 }
@@ -386,45 +893,142 @@ static const repl_command_t *find_command(const char *name) {
     return NULL;
 }
 
+typedef enum { LINE_OK, LINE_UNKNOWN, LINE_FAILED, LINE_QUIT } line_status_t;
+
+/* Run one command line; the line is split in place, never copied */
+static line_status_t run_line(agc_cpu_t *cpu, char *line, bool *rom_loaded) {
+    /* strip newline */
+    line[strcspn(line, "\r\n")] = '\0';
+
+    /* skip empty lines and comments */
+    const char *start = skip_ws(line);
+    if (start[0] == '\0' || start[0] == '#')
+        return LINE_OK;
+
+    char *cmd, *args;
+    split_command(line, &cmd, &args);
+
+    const repl_command_t *entry = find_command(cmd);
+    if (!entry)
+        return LINE_UNKNOWN;
+    if (entry->run(cpu, args, rom_loaded))
+        return LINE_OK;
+    return entry->run == cmd_quit ? LINE_QUIT : LINE_FAILED;
+}
+
 static void repl(void) {
     agc_cpu_t cpu;
     agc_cpu_reset(&cpu);
 
     bool rom_loaded = false;
 
-    printf(CLR_HEADER "AGC Emulator Interactive Mode\n" CLR_RESET);
+    printf("%sAGC Emulator Interactive Mode\n%s", CLR_HEADER, CLR_RESET);
     print_usage(NULL);
+    if (startup_core && !attach_core(&cpu, startup_core))
+        return;
 
     char line[256];
 
     for (;;) {
-        printf(CLR_PROMPT "agc> " CLR_RESET);
+        printf("%sagc> %s", CLR_PROMPT, CLR_RESET);
         if (!fgets(line, sizeof(line), stdin))
             break;
 
-        /* strip newline */
-        line[strcspn(line, "\r\n")] = '\0';
-
-        /* skip empty lines */
-        if (skip_ws(line)[0] == '\0')
+        line_status_t status = run_line(&cpu, line, &rom_loaded);
+        if (status == LINE_UNKNOWN) {
+            printf("%sUnknown command: %s\n%s", CLR_ERROR, skip_ws(line), CLR_RESET);
+            print_usage(NULL);
             continue;
+        }
+        if (status != LINE_OK)
+            break;
+    }
+}
 
-        char *cmd, *args;
-        split_command(line, &cmd, &args);
+/*
+ * Batch mode: run a script (or stdin) with no banner, prompts or colors
+ * and fully buffered output. Stops at the first unknown or failing
+ * command. Exit status: 0 if every "expect" held, 1 if one failed,
+ * 2 for a script error.
+ */
+static int batch(const char *path) {
+    FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!in) {
+        fprintf(stderr, "agc_main: cannot open %s\n", path);
+        return 2;
+    }
+    use_color = false;
+    batch_mode = true;
+    script_name = strcmp(path, "-") == 0 ? "<stdin>" : path;
+    setvbuf(stdout, NULL, _IOFBF, 1 << 16);
 
-        const repl_command_t *entry = find_command(cmd);
-        if (!entry) {
-            printf(CLR_ERROR "Unknown command: %s\n" CLR_RESET, cmd);
-            print_usage(NULL);
-            continue;
+    static agc_cpu_t cpu;
+    agc_cpu_reset(&cpu);
+    bool rom_loaded = false;
+    int status = 0;
+    if (startup_core && !attach_core(&cpu, startup_core)) {
+        if (in != stdin) fclose(in);
+        fflush(stdout);
+        return 2;
+    }
+
+    char line[1024];
+    while (fgets(line, sizeof(line), in)) {
+        script_line++;
+        line_status_t st = run_line(&cpu, line, &rom_loaded);
+        if (st == LINE_OK) continue;
+        if (st != LINE_QUIT) {
+            fflush(stdout);
+            fprintf(stderr, "%s:%lu: %s: %s\n", script_name, script_line,
+                    st == LINE_UNKNOWN ? "unknown command" : "command failed", skip_ws(line));
+            status = 2;
         }
+        break;
+    }
 
-        if (!entry->run(&cpu, args, &rom_loaded))
-            break;
+    if (in != stdin) fclose(in);
+    fflush(stdout);
+    if (status == 0 && expect_failures) {
+        fprintf(stderr, "%s: %lu expectation%s failed\n", script_name, expect_failures,
+                expect_failures == 1 ? "" : "s");
+        status = 1;
     }
+    return status;
 }
 
-int main(void) {
+/* Fatal signal: save the trace before dying (write(2) only, see agc_trace.h) */
+static void dump_trace_on_fault(int sig) {
+    if (tracing) {
+        int fd = open(FAULT_TRACE_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            agc_trace_dump_fd(&trace_ring, fd);
+            close(fd);
+        }
+    }
+    raise(sig);
+}
+
+int main(int argc, char **argv) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = dump_trace_on_fault;
+    sa.sa_flags = SA_RESETHAND;
+    sigemptyset(&sa.sa_mask);
+    const int faults[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+    for (size_t i = 0; i < sizeof(faults) / sizeof(faults[0]); i++)
+        sigaction(faults[i], &sa, NULL);
+
+    int arg = 1;
+    if (arg + 1 < argc && strcmp(argv[arg], "--core") == 0) {
+        startup_core = argv[arg + 1];
+        arg += 2;
+    }
+    if (arg < argc) {
+        if (strcmp(argv[arg], "--batch") == 0 && argc - arg <= 2)
+            return batch(argc - arg == 2 ? argv[arg + 1] : "-");
+        fprintf(stderr, "usage: agc_main [--core file] [--batch [script|-]]\n");
+        return 2;
+    }
     repl();
     return 0;
 }
@@ -1,7 +1,24 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
 #include "agc_cpu.h"
 #include "agc_memory.h"
 #include "agc_instructions.h"
+#include "agc_timing.h"
+#include "agc_snapshot.h"
+#include "agc_journal.h"
+#include "agc_rope.h"
+#include "agc_campaign.h"
+#include "agc_lanes.h"
+#include "agc_profiler.h"
+#include "agc_debug.h"
+#include "agc_trace.h"
+#include "agc_channels.h"
+#include "agc_sched.h"
+#include "agc_corefile.h"
+#include "agc_checkpoint.h"
 
 int test_tc(void);
 int test_ca(void);
@@ -10,6 +27,31 @@ int test_xch(void);
 int test_xch_erasable_bank0(void);
 int test_xch_rom(void);
 int test_xch_erasable_bank_n(void);
+int test_instances_isolated(void);
+int test_bank_switch_cache(void);
+int test_exec_program(void);
+int test_fixed_decoded(void);
+int test_run_stop_conditions(void);
+int test_run_io_stop(void);
+int test_paced_run(void);
+int test_idle_skip_exact(void);
+int test_hot_fixed_loop(void);
+int test_rope_rewrite(void);
+int test_snapshot_roundtrip(void);
+int test_journal_replay(void);
+int test_rope_formats(void);
+int test_rope_registry(void);
+int test_campaign(void);
+int test_lanes_match_scalar(void);
+int test_profiler_counts(void);
+int test_debug_points(void);
+int test_trace_ring(void);
+int test_channel_queues(void);
+int test_channel_journal(void);
+int test_sched_events(void);
+int test_sched_timers(void);
+int test_core_file(void);
+int test_checkpoint_deltas(void);
 
 int main(void) {
     int failed = 0;
@@ -21,6 +63,31 @@ int main(void) {
     failed |= test_xch_erasable_bank0();
     failed |= test_xch_rom();
     failed |= test_xch_erasable_bank_n();
+    failed |= test_instances_isolated();
+    failed |= test_bank_switch_cache();
+    failed |= test_exec_program();
+    failed |= test_fixed_decoded();
+    failed |= test_run_stop_conditions();
+    failed |= test_run_io_stop();
+    failed |= test_paced_run();
+    failed |= test_idle_skip_exact();
+    failed |= test_hot_fixed_loop();
+    failed |= test_rope_rewrite();
+    failed |= test_snapshot_roundtrip();
+    failed |= test_journal_replay();
+    failed |= test_rope_formats();
+    failed |= test_rope_registry();
+    failed |= test_campaign();
+    failed |= test_lanes_match_scalar();
+    failed |= test_profiler_counts();
+    failed |= test_debug_points();
+    failed |= test_trace_ring();
+    failed |= test_channel_queues();
+    failed |= test_channel_journal();
+    failed |= test_sched_events();
+    failed |= test_sched_timers();
+    failed |= test_core_file();
+    failed |= test_checkpoint_deltas();
 
     if (failed) {
         printf("SOME TESTS FAILED\n");
@@ -280,10 +347,10 @@ int test_xch_erasable_bank_n(void) {
     cpu.EB = 1;
 
     // Set up memory in bank 1 at address 0150
-    agc_erasable_set(1, 0150, 04444);
+    agc_erasable_set(&cpu, 1, 0150, 04444);
 
     // Also set bank 0 at same address to verify bank separation
-    agc_erasable_set(0, 0150, 02222);
+    agc_erasable_set(&cpu, 0, 0150, 02222);
 
     // Save initial state
     agc_word_t initial_A = cpu.A;
@@ -307,14 +374,14 @@ int test_xch_erasable_bank_n(void) {
     }
 
     // Check memory in bank 1 got A's value
-    agc_word_t bank1_mem = agc_erasable_get(1, 0150);
+    agc_word_t bank1_mem = agc_erasable_get(&cpu, 1, 0150);
     if (bank1_mem != 07777) {
         printf("TEST FAILED: XCH bank N - Expected bank1[0150] = 07777, got %04o\n", bank1_mem);
         return 1;
     }
 
     // Check bank 0 is untouched
-    agc_word_t bank0_mem = agc_erasable_get(0, 0150);
+    agc_word_t bank0_mem = agc_erasable_get(&cpu, 0, 0150);
     if (bank0_mem != 02222) {
         printf("TEST FAILED: XCH bank N - Bank 0 changed to %04o\n", bank0_mem);
         return 1;
@@ -329,3 +396,1272 @@ int test_xch_erasable_bank_n(void) {
     printf("TEST PASSED: XCH with erasable bank N\n");
     return 0;
 }
+
+/*
+ * Test that two instances do not share erasable memory,
+ * while both read the same caller-owned rope image.
+ */
+int test_instances_isolated(void) {
+    static agc_rope_t rope;
+    static agc_cpu_t a, b;
+    agc_cpu_reset(&a);
+    agc_cpu_reset(&b);
+
+    rope.words[0] = 06543;
+    agc_rope_decode(&rope);
+    agc_memory_attach_rope(&a, &rope);
+    agc_memory_attach_rope(&b, &rope);
+
+    agc_memory_write(&a, 0100, 01111);
+    agc_memory_write(&b, 0100, 02222);
+
+    // Check each instance sees only its own erasable write
+    if (agc_memory_read(&a, 0100) != 01111 || agc_memory_read(&b, 0100) != 02222) {
+        printf("TEST FAILED: instances share erasable memory\n");
+        return 1;
+    }
+
+    // Address 02000 maps to rope word 0 when FB=0
+    if (agc_memory_read(&a, 02000) != 06543 || agc_memory_read(&b, 02000) != 06543) {
+        printf("TEST FAILED: attached rope not visible to both instances\n");
+        return 1;
+    }
+
+    printf("TEST PASSED: instances own erasable memory and share a rope\n");
+    return 0;
+}
+
+/*
+ * Test that bank switches made by writing EB/FB directly are seen
+ * by the next access, and that reads past the rope end clamp.
+ */
+int test_bank_switch_cache(void) {
+    static agc_cpu_t cpu;
+    agc_cpu_reset(&cpu);
+
+    agc_erasable_set(&cpu, 0, 0120, 01111);
+    agc_erasable_set(&cpu, 1, 0120, 02222);
+
+    if (agc_memory_read(&cpu, 0120) != 01111) {
+        printf("TEST FAILED: bank cache - EB=0 read wrong word\n");
+        return 1;
+    }
+
+    cpu.EB = 1;
+    if (agc_memory_read(&cpu, 0120) != 02222) {
+        printf("TEST FAILED: bank cache - EB switch not seen\n");
+        return 1;
+    }
+
+    // Fixed bank 8 holds the last 4K of the rope; beyond it reads clamp
+    agc_rom_set(AGC_ROM_SIZE - 1, 03456);
+    cpu.FB = 8;
+    if (agc_memory_read(&cpu, 02000 + AGC_FIXED_BANK_SIZE - 1) != 03456 ||
+        agc_memory_read(&cpu, 077777) != 03456) {
+        printf("TEST FAILED: bank cache - fixed bank 8 clamp\n");
+        return 1;
+    }
+    agc_rom_set(AGC_ROM_SIZE - 1, 0);
+
+    printf("TEST PASSED: bank switches update the translation cache\n");
+    return 0;
+}
+
+/*
+ * Test a short program run with agc_cpu_exec().
+ * Exercises the selected interpreter core across several instructions.
+ */
+int test_exec_program(void) {
+    static agc_cpu_t cpu;
+    agc_cpu_reset(&cpu);
+
+    agc_memory_write(&cpu, 0100, 01357);
+    agc_memory_write(&cpu, 0, 030100);  // CA 0100
+    agc_memory_write(&cpu, 1, 020101);  // TS 0101
+    agc_memory_write(&cpu, 2, 010102);  // XCH 0102
+    agc_memory_write(&cpu, 3, 000001);  // TC 0001
+
+    uint64_t n = agc_cpu_exec(&cpu, 6);
+
+    // CA, TS, XCH, TC, TS, XCH: the second XCH swaps A back
+    // Five 2-MCT instructions plus one 1-MCT TC
+    if (n != 6 || cpu.cycle_count != 11) {
+        printf("TEST FAILED: exec - Expected 6 instructions, got %llu\n",
+               (unsigned long long)n);
+        return 1;
+    }
+    if (cpu.Z != 3 || cpu.A != 01357 ||
+        agc_memory_read(&cpu, 0101) != 0 || agc_memory_read(&cpu, 0102) != 0) {
+        printf("TEST FAILED: exec - Z=%04o A=%04o\n", cpu.Z, cpu.A);
+        return 1;
+    }
+
+    printf("TEST PASSED: exec ran a multi-instruction program\n");
+    return 0;
+}
+
+/*
+ * Test execution from fixed memory through the decoded rope table.
+ * FB=1 selects rope words 010000+; control returns to erasable via TC.
+ */
+int test_fixed_decoded(void) {
+    static agc_rope_t rope;
+    static agc_cpu_t cpu;
+    agc_cpu_reset(&cpu);
+
+    rope.words[010000] = 030100;  // CA 0100
+    rope.words[010001] = 020101;  // TS 0101
+    rope.words[010002] = 000005;  // TC 0005
+    agc_rope_decode(&rope);
+    agc_memory_attach_rope(&cpu, &rope);
+
+    agc_memory_write(&cpu, 0100, 04321);
+    cpu.FB = 1;
+    cpu.Z = 02000;
+
+    agc_cpu_exec(&cpu, 3);
+
+    if (cpu.A != 04321 || agc_memory_read(&cpu, 0101) != 04321) {
+        printf("TEST FAILED: fixed decode - A=%04o\n", cpu.A);
+        return 1;
+    }
+    if (cpu.Z != 5 || cpu.current_instruction != 000005) {
+        printf("TEST FAILED: fixed decode - Z=%04o instr=%04o\n",
+               cpu.Z, cpu.current_instruction);
+        return 1;
+    }
+
+    printf("TEST PASSED: fixed memory runs from the decoded rope table\n");
+    return 0;
+}
+
+/*
+ * Test agc_cpu_run() stop reasons on a straight-line program.
+ * Four CA instructions followed by TC 0000 form a 5-instruction loop.
+ */
+int test_run_stop_conditions(void) {
+    static agc_cpu_t cpu;
+    agc_cpu_reset(&cpu);
+
+    agc_memory_write(&cpu, 0, 030100);  // CA 0100
+    agc_memory_write(&cpu, 1, 030100);
+    agc_memory_write(&cpu, 2, 030100);
+    agc_memory_write(&cpu, 3, 030100);
+    agc_memory_write(&cpu, 4, 000000);  // TC 0000
+
+    uint64_t executed;
+    agc_stop_reason_t reason = agc_cpu_run(&cpu, 7, 0, &executed);
+    if (reason != AGC_STOP_COUNT || executed != 7 || cpu.Z != 2) {
+        printf("TEST FAILED: run count - reason %d, executed %llu, Z=%04o\n",
+               reason, (unsigned long long)executed, cpu.Z);
+        return 1;
+    }
+
+    agc_cpu_add_breakpoint(&cpu, 4);
+    reason = agc_cpu_run(&cpu, 100, AGC_STOP_BREAKPOINT, &executed);
+    if (reason != AGC_STOP_BREAKPOINT || executed != 2 || cpu.Z != 4) {
+        printf("TEST FAILED: run breakpoint - reason %d, executed %llu, Z=%04o\n",
+               reason, (unsigned long long)executed, cpu.Z);
+        return 1;
+    }
+    agc_cpu_clear_breakpoints(&cpu);
+
+    agc_cpu_set_stop_range(&cpu, 2, 3);
+    reason = agc_cpu_run(&cpu, 100, AGC_STOP_Z_RANGE | AGC_STOP_IO_WRITE, &executed);
+    if (reason != AGC_STOP_Z_RANGE || executed != 3 || cpu.Z != 2) {
+        printf("TEST FAILED: run Z range - reason %d, executed %llu, Z=%04o\n",
+               reason, (unsigned long long)executed, cpu.Z);
+        return 1;
+    }
+
+    printf("TEST PASSED: run stops on count, breakpoint and Z range\n");
+    return 0;
+}
+
+static void write_out5(agc_cpu_t *cpu, void *ctx) {
+    (void)ctx;
+    agc_io_write(cpu, 5, 0123);
+}
+
+/*
+ * Test the I/O-write stop. No instruction writes a channel, so the write
+ * comes from an event that fires partway through the run.
+ */
+int test_run_io_stop(void) {
+    static agc_cpu_t cpu;
+    static agc_sched_t sched;
+    agc_cpu_reset(&cpu);
+    agc_sched_init(&sched);
+    agc_sched_attach(&cpu, &sched);
+
+    // TC 0001, TC 0002, TC 0003, TC 0000: one MCT per instruction
+    for (agc_word_t i = 0; i < 4; i++)
+        agc_memory_write(&cpu, i, (i + 1) & 3);
+
+    agc_sched_after(&cpu, 6, write_out5, NULL);
+    uint64_t executed;
+    agc_stop_reason_t reason = agc_cpu_run(&cpu, 100, AGC_STOP_IO_WRITE, &executed);
+    agc_sched_attach(&cpu, NULL);
+    if (reason != AGC_STOP_IO_WRITE || executed != 6 || cpu.Z != 2 || cpu.OUT[5] != 0123) {
+        printf("TEST FAILED: run I/O write - reason %d, executed %llu, Z=%04o\n",
+               reason, (unsigned long long)executed, cpu.Z);
+        return 1;
+    }
+
+    printf("TEST PASSED: run stops on a channel write from an event\n");
+    return 0;
+}
+
+/*
+ * Test that a paced run takes the emulated time in wall-clock time.
+ * A TC self-loop costs 1 MCT per instruction; 1280 MCT is 15 ms.
+ */
+int test_paced_run(void) {
+    static agc_cpu_t cpu;
+    agc_cpu_reset(&cpu);
+
+    agc_memory_write(&cpu, 0, 000000);  // TC 0000
+
+    agc_pacer_t pacer;
+    struct timespec start, end;
+    uint64_t executed;
+
+    timespec_get(&start, TIME_UTC);
+    agc_pacer_start(&pacer, &cpu, 1.0);
+    agc_cpu_run_paced(&cpu, &pacer, 1280, 0, &executed);
+    timespec_get(&end, TIME_UTC);
+
+    double ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) * 1e-6;
+    // 2.56e14 MCT is 3e18 ns; multiplying first would overflow
+    if (executed != 1280 || cpu.cycle_count != 1280 || agc_mct_to_ns(1280) != 15000000 ||
+        agc_mct_to_ns(AGC_MCT_PER_3S * 1000000000 + 1280) != 3000000000015000000ULL) {
+        printf("TEST FAILED: paced run - executed %llu, cycles %llu\n",
+               (unsigned long long)executed, (unsigned long long)cpu.cycle_count);
+        return 1;
+    }
+    if (ms < 14.0) {
+        printf("TEST FAILED: paced run - finished in %.2f ms, expected 15 ms\n", ms);
+        return 1;
+    }
+
+    printf("TEST PASSED: paced run held real-time rate (%.2f ms)\n", ms);
+    return 0;
+}
+
+/*
+ * Test that fast-forwarding idle loops gives the same final state as
+ * emulating every pass, for a no-progress loop and for one that is not.
+ */
+static void load_idle_programs(agc_cpu_t *cpu) {
+    agc_memory_write(cpu, 0100, 01234);
+    agc_memory_write(cpu, 0, 030100);   // CA 0100
+    agc_memory_write(cpu, 1, 020101);   // TS 0101
+    agc_memory_write(cpu, 2, 000000);   // TC 0000   (no progress)
+    agc_memory_write(cpu, 010, 010102); // XCH 0102
+    agc_memory_write(cpu, 011, 000010); // TC 0010   (A toggles)
+}
+
+int test_idle_skip_exact(void) {
+    static agc_cpu_t fast, slow;
+
+    for (int start = 0; start <= 010; start += 010) {
+        agc_cpu_reset(&fast);
+        agc_cpu_reset(&slow);
+        load_idle_programs(&fast);
+        load_idle_programs(&slow);
+        fast.Z = slow.Z = (agc_word_t)start;
+        slow.idle_skip = false;
+        fast.next_event = slow.next_event = 100000;
+
+        agc_cpu_exec(&fast, 1000001);
+        agc_cpu_exec(&slow, 1000001);
+
+        if (fast.A != slow.A || fast.Z != slow.Z ||
+            fast.cycle_count != slow.cycle_count ||
+            fast.current_instruction != slow.current_instruction ||
+            memcmp(fast.erasable, slow.erasable, AGC_RAM_BYTES) != 0) {
+            printf("TEST FAILED: idle skip from %04o - Z %04o/%04o cycles %llu/%llu\n",
+                   start, fast.Z, slow.Z,
+                   (unsigned long long)fast.cycle_count,
+                   (unsigned long long)slow.cycle_count);
+            return 1;
+        }
+    }
+
+    printf("TEST PASSED: idle loop fast-forward matches full emulation\n");
+    return 0;
+}
+
+/*
+ * Test a hot loop through fixed memory, batched versus single-stepped.
+ * In superblock builds the batched run executes compiled blocks; an EB
+ * switch halfway must invalidate them.
+ */
+static void load_fixed_loop(agc_cpu_t *cpu, const agc_rope_t *rope) {
+    agc_memory_attach_rope(cpu, rope);
+
+    // Same loop head in both erasable banks, different data
+    for (uint8_t eb = 0; eb < 2; eb++) {
+        cpu->EB = eb;
+        agc_memory_write(cpu, 01777, 010100);   // XCH 0100, falls into 02000
+        agc_memory_write(cpu, 0100, 01111 * (eb + 1));
+        agc_memory_write(cpu, 0102, 03333 * (eb + 1));
+    }
+
+    cpu->EB = 0;
+    cpu->FB = 1;
+    cpu->Z = 01777;
+}
+
+int test_hot_fixed_loop(void) {
+    static agc_rope_t rope;
+    static agc_cpu_t batched, stepped;
+
+    // Values rotate through A, 0100 and 0102, so this is never idle
+    rope.words[010000] = 020101;  // TS 0101
+    rope.words[010001] = 010102;  // XCH 0102
+    rope.words[010002] = 030101;  // CA 0101
+    rope.words[010003] = 020103;  // TS 0103
+    rope.words[010004] = 001777;  // TC 1777
+    agc_rope_decode(&rope);
+
+    agc_cpu_reset(&batched);
+    agc_cpu_reset(&stepped);
+    load_fixed_loop(&batched, &rope);
+    load_fixed_loop(&stepped, &rope);
+
+    for (int round = 0; round < 2; round++) {
+        agc_cpu_exec(&batched, 1003);
+        for (int i = 0; i < 1003; i++)
+            agc_cpu_step(&stepped);
+
+        if (batched.A != stepped.A || batched.Z != stepped.Z ||
+            batched.cycle_count != stepped.cycle_count ||
+            batched.current_instruction != stepped.current_instruction ||
+            memcmp(batched.erasable, stepped.erasable, AGC_RAM_BYTES) != 0) {
+            printf("TEST FAILED: hot fixed loop round %d - A %04o/%04o Z %04o/%04o\n",
+                   round, batched.A, stepped.A, batched.Z, stepped.Z);
+            return 1;
+        }
+
+        batched.EB = stepped.EB = 1;
+    }
+
+    printf("TEST PASSED: hot fixed-memory loop matches single stepping\n");
+    return 0;
+}
+
+/*
+ * Test that rewriting a word of the default rope is seen by the next
+ * batched run, even after the code around it was compiled into a block.
+ */
+int test_rope_rewrite(void) {
+    static agc_cpu_t cpu;
+    agc_cpu_reset(&cpu);
+
+    agc_rom_set(0, 030100);   // CA 0100
+    agc_rom_set(1, 020101);   // TS 0101
+    agc_rom_set(2, 001777);   // TC 1777
+    agc_memory_write(&cpu, 01777, 010103);  // XCH 0103, falls into 02000
+    agc_memory_write(&cpu, 0100, 01234);
+    cpu.Z = 01777;
+    cpu.idle_skip = false;  // The loop settles; keep executing it
+
+    agc_cpu_exec(&cpu, 1000);
+
+    agc_rom_set(1, 020102);   // TS 0102
+    agc_memory_write(&cpu, 0101, 0);
+    agc_cpu_exec(&cpu, 1000);
+
+    agc_word_t old_target = agc_memory_read(&cpu, 0101);
+    agc_word_t new_target = agc_memory_read(&cpu, 0102);
+    for (uint32_t i = 0; i < 3; i++)
+        agc_rom_set(i, 0);
+
+    if (old_target != 0 || new_target != 01234) {
+        printf("TEST FAILED: rope rewrite - 0101=%04o 0102=%04o\n", old_target, new_target);
+        return 1;
+    }
+
+    printf("TEST PASSED: rewritten rope words replace cached code\n");
+    return 0;
+}
+
+/*
+ * Test that restoring a snapshot rewinds registers, channels and
+ * erasable memory, and that a blob with a bad version is rejected.
+ */
+int test_snapshot_roundtrip(void) {
+    static agc_cpu_t cpu;
+    static agc_snapshot_t snap;
+    agc_cpu_reset(&cpu);
+
+    agc_memory_write(&cpu, 0, 010100);  // XCH 0100
+    agc_memory_write(&cpu, 1, 000000);  // TC 0000
+    agc_memory_write(&cpu, 0100, 02525);
+    cpu.A = 05252;
+    cpu.IN[3] = 0123;
+
+    agc_snapshot_take(&cpu, &snap);
+
+    agc_cpu_exec(&cpu, 3);
+    cpu.EB = 1;
+    cpu.IN[3] = 0;
+    agc_io_write(&cpu, 5, 077);
+
+    if (!agc_snapshot_restore(&cpu, &snap)) {
+        printf("TEST FAILED: snapshot - restore rejected a valid blob\n");
+        return 1;
+    }
+    if (cpu.A != 05252 || cpu.Z != 0 || cpu.EB != 0 || cpu.cycle_count != 0 ||
+        cpu.IN[3] != 0123 || cpu.OUT[5] != 0 ||
+        agc_memory_read(&cpu, 0100) != 02525) {
+        printf("TEST FAILED: snapshot - state not restored (A=%04o Z=%04o)\n", cpu.A, cpu.Z);
+        return 1;
+    }
+
+    snap.version++;
+    if (agc_snapshot_restore(&cpu, &snap)) {
+        printf("TEST FAILED: snapshot - accepted a wrong version\n");
+        return 1;
+    }
+
+    printf("TEST PASSED: snapshot restore rewinds the instance\n");
+    return 0;
+}
+
+int test_journal_replay(void) {
+    static agc_cpu_t cpu, replayed;
+    static agc_snapshot_t a, b;
+    const char *path = "test_journal.agcj";
+    agc_journal_t rec, loaded;
+    agc_journal_init(&rec);
+    agc_journal_init(&loaded);
+    agc_cpu_reset(&cpu);
+
+    agc_memory_write(&cpu, 0, 010100);  // XCH 0100
+    agc_memory_write(&cpu, 1, 000000);  // TC 0000
+    agc_memory_write(&cpu, 0100, 01111);
+    agc_memory_write(&cpu, 01400, 010100);  // same loop head in EB 1
+    agc_memory_write(&cpu, 01401, 000000);
+
+    agc_journal_begin(&rec, &cpu);
+    agc_cpu_exec(&cpu, 7);
+    agc_journal_input(&rec, &cpu, AGC_JOURNAL_POKE, 0100, 02222);
+    agc_journal_input(&rec, &cpu, AGC_JOURNAL_IN, 4, 0321);
+    agc_cpu_exec(&cpu, 12);
+    agc_journal_input(&rec, &cpu, AGC_JOURNAL_EB, 0, 1);
+    agc_cpu_exec(&cpu, 5);
+    agc_journal_input(&rec, &cpu, AGC_JOURNAL_POKE, 0100, 03333);
+    agc_cpu_exec(&cpu, 9);
+    agc_journal_end(&rec, &cpu);
+
+    if (!agc_journal_save(&rec, path) || !agc_journal_load(&loaded, path)) {
+        printf("TEST FAILED: journal - save/load round trip\n");
+        remove(path);
+        return 1;
+    }
+
+    // A header claiming more entries than the file holds is rejected
+    uint64_t bogus = (1ull << 60) + 1;
+    FILE *f = fopen(path, "r+b");
+    bool patched = f && fseek(f, 8, SEEK_SET) == 0 && fwrite(&bogus, sizeof(bogus), 1, f) == 1;
+    if (f) fclose(f);
+    agc_journal_t crafted;
+    agc_journal_init(&crafted);
+    if (!patched || agc_journal_load(&crafted, path)) {
+        printf("TEST FAILED: journal - oversized entry count accepted\n");
+        agc_journal_free(&crafted);
+        remove(path);
+        return 1;
+    }
+    remove(path);
+
+    agc_cpu_reset(&replayed);
+    replayed.A = 07777;  // replay must not depend on prior state
+    bool ok = agc_journal_replay(&loaded, &replayed);
+
+    agc_snapshot_take(&cpu, &a);
+    agc_snapshot_take(&replayed, &b);
+    int failed = !ok || loaded.count != 4 || memcmp(&a, &b, sizeof(a)) != 0;
+    agc_journal_free(&rec);
+    agc_journal_free(&loaded);
+    if (failed) {
+        printf("TEST FAILED: journal - replay diverged (cycle %llu vs %llu)\n",
+               (unsigned long long)replayed.cycle_count, (unsigned long long)cpu.cycle_count);
+        return 1;
+    }
+
+    printf("TEST PASSED: journal replay reproduces the recorded run\n");
+    return 0;
+}
+
+int test_rope_formats(void) {
+    static agc_rope_t loaded;
+    static agc_cpu_t a, b;
+    const agc_word_t words[4] = { 030036, 000004, 077777, 012345 };
+    const char *bin = "test_rope.bin", *dump = "test_rope.dump", *src = "test_rope.binsource";
+    const char *odd = "test_rope_odd.bin";
+
+    FILE *f = fopen(bin, "wb");
+    for (int i = 0; i < 4; i++) { fputc(words[i] >> 8, f); fputc(words[i] & 0xff, f); }
+    fclose(f);
+    f = fopen(dump, "wb");
+    fwrite(words, sizeof(agc_word_t), 4, f);
+    fclose(f);
+    f = fopen(src, "w");
+    fprintf(f, "; test rope\nBANK=0\n30036 00004\n77777 12345 ; trailing\n");
+    fclose(f);
+    f = fopen(odd, "wb");
+    fputc(0x30, f); fputc(0x1e, f); fputc(0x00, f);
+    fclose(f);
+
+    const char *paths[3] = { bin, dump, src };
+    const agc_rope_format_t expect[3] = { AGC_ROPE_BIN, AGC_ROPE_HOST, AGC_ROPE_BINSOURCE };
+    uint64_t checksum = 0;
+    int failed = 0;
+    for (int i = 0; i < 3 && !failed; i++) {
+        agc_rope_info_t info;
+        if (!agc_rope_load_format(&loaded, paths[i], AGC_ROPE_AUTO, &info) ||
+            info.format != expect[i] || info.words != 4 ||
+            memcmp(loaded.words, words, sizeof(words)) != 0 || loaded.words[4] != 0 ||
+            (i > 0 && info.checksum != checksum)) {
+            printf("TEST FAILED: rope - %s not loaded as %s\n", paths[i], agc_rope_format_name(expect[i]));
+            failed = 1;
+        }
+        checksum = info.checksum;
+    }
+
+    if (!failed && agc_rope_load_format(&loaded, odd, AGC_ROPE_AUTO, NULL)) {
+        printf("TEST FAILED: rope - truncated image accepted\n");
+        failed = 1;
+    }
+
+    const agc_rope_t *shared = failed ? NULL : agc_rope_map(bin, AGC_ROPE_AUTO, NULL);
+    if (!failed) {
+        agc_cpu_reset(&a);
+        agc_cpu_reset(&b);
+        agc_memory_attach_rope(&a, shared);
+        agc_memory_attach_rope(&b, shared);
+        if (!shared || agc_rope_checksum(shared) != checksum ||
+            agc_memory_read(&a, 02001) != 000004 || a.page[1] != b.page[1]) {
+            printf("TEST FAILED: rope - mapped image not shared\n");
+            failed = 1;
+        }
+        agc_rope_unmap(shared);
+    }
+
+    remove(bin);
+    remove(dump);
+    remove(src);
+    remove(odd);
+    if (failed)
+        return 1;
+
+    printf("TEST PASSED: rope images load in every format and map shared\n");
+    return 0;
+}
+
+int test_rope_registry(void) {
+    const char *p1 = "test_registry_a.bin", *p2 = "test_registry_b.bin";
+    for (int i = 0; i < 2; i++) {
+        FILE *f = fopen(i ? p2 : p1, "wb");
+        fputc(0x30, f); fputc(0x1e, f); fputc(0x00, f); fputc(0x04, f);
+        fclose(f);
+    }
+
+    size_t before = agc_rope_resident();
+    const agc_rope_t *r1 = agc_rope_acquire(p1, NULL);
+    const agc_rope_t *r2 = agc_rope_acquire(p1, NULL);
+    const agc_rope_t *r3 = agc_rope_acquire(p2, NULL);
+    size_t during = agc_rope_resident();
+
+    int failed = !r1 || r1 != r2 || r1 != r3 || during != before + 1 ||
+                 r1->words[0] != 030036;
+    agc_rope_release(r1);
+    agc_rope_release(r2);
+    if (agc_rope_resident() != during)
+        failed = 1;
+    agc_rope_release(r3);
+    if (agc_rope_resident() != before)
+        failed = 1;
+
+    remove(p1);
+    remove(p2);
+    if (failed) {
+        printf("TEST FAILED: rope registry - images not shared or not released\n");
+        return 1;
+    }
+
+    printf("TEST PASSED: rope registry shares one image per content\n");
+    return 0;
+}
+
+int test_campaign(void) {
+    enum { RUNS = 300 };
+    static agc_cpu_t cpu;
+    static agc_snapshot_t base;
+    static agc_perturbation_t items[RUNS];
+    static size_t first[RUNS + 1];
+    static agc_campaign_result_t serial[RUNS], parallel[RUNS];
+    agc_cpu_reset(&cpu);
+
+    agc_memory_write(&cpu, 0, 030100);  // CA 0100
+    agc_memory_write(&cpu, 1, 020101);  // TS 0101
+    agc_memory_write(&cpu, 2, 000002);  // TC 0002
+    agc_snapshot_take(&cpu, &base);
+
+    for (size_t i = 0; i < RUNS; i++) {
+        items[i] = (agc_perturbation_t){ AGC_PERTURB_ERASABLE, 0, 0100, (agc_word_t)i };
+        first[i] = i;
+    }
+    first[RUNS] = RUNS;
+
+    agc_campaign_t c = {
+        .base = &base,
+        .runs = { items, first, RUNS },
+        .max_instructions = 40,
+        .threads = 1,
+        .results = serial,
+    };
+    const char *path = "test_campaign.agcr";
+    FILE *out = fopen(path, "w+b");
+    bool ok = agc_campaign_run(&c);
+    c.threads = 4;
+    c.results = parallel;
+    c.out = out;
+    ok = ok && agc_campaign_run(&c);
+
+    agc_campaign_header_t h = { 0 };
+    size_t records = 0;
+    agc_campaign_result_t r;
+    rewind(out);
+    if (fread(&h, sizeof(h), 1, out) == 1)
+        while (fread(&r, sizeof(r), 1, out) == 1)
+            records++;
+    fclose(out);
+    remove(path);
+
+    if (!ok || h.magic != AGC_CAMPAIGN_MAGIC || h.run_count != RUNS || records != RUNS) {
+        printf("TEST FAILED: campaign - result stream incomplete (%zu records)\n", records);
+        return 1;
+    }
+    for (size_t i = 0; i < RUNS; i++) {
+        if (serial[i].run != i || serial[i].A != i || serial[i].executed != 40 ||
+            memcmp(&serial[i], &parallel[i], sizeof(serial[i])) != 0) {
+            printf("TEST FAILED: campaign - run %zu differs (A=%04o)\n", i, serial[i].A);
+            return 1;
+        }
+    }
+
+    printf("TEST PASSED: campaign runs match across thread counts\n");
+    return 0;
+}
+
+int test_lanes_match_scalar(void) {
+    static agc_cpu_t cpu[AGC_LANES], out;
+    static agc_lanes_t lanes;
+    static agc_snapshot_t a, b;
+    agc_lanes_init(&lanes, NULL);
+
+    for (int i = 0; i < AGC_LANES; i++) {
+        agc_cpu_reset(&cpu[i]);
+        cpu[i].EB = (uint8_t)(i >= 12);                  // Lanes 12-15 run from bank 1
+        agc_memory_write(&cpu[i], 0, 010100);            // XCH 0100
+        agc_memory_write(&cpu[i], 1, 020101);            // TS 0101
+        agc_memory_write(&cpu[i], 2, i & 1 ? 000005 : 000000);  // TC 5 on odd lanes
+        agc_memory_write(&cpu[i], 5, 030101);            // CA 0101
+        agc_memory_write(&cpu[i], 6, 000000);            // TC 0
+        agc_memory_write(&cpu[i], 0100, (agc_word_t)(01000 + i));
+        cpu[i].A = (agc_word_t)i;
+        agc_lanes_load(&lanes, i, &cpu[i]);
+    }
+
+    agc_lanes_exec(&lanes, 101);
+    for (int i = 0; i < AGC_LANES; i++) {
+        agc_cpu_exec(&cpu[i], 101);
+        out = cpu[i];
+        agc_lanes_store(&lanes, i, &out);
+        agc_snapshot_take(&cpu[i], &a);
+        agc_snapshot_take(&out, &b);
+        if (memcmp(&a, &b, sizeof(a)) != 0) {
+            printf("TEST FAILED: lanes - lane %d diverged from scalar (A=%04o vs %04o, Z=%04o vs %04o)\n",
+                   i, out.A, cpu[i].A, out.Z, cpu[i].Z);
+            return 1;
+        }
+    }
+    if (lanes.groups <= lanes.steps) {
+        printf("TEST FAILED: lanes - divergent lanes never split\n");
+        return 1;
+    }
+
+    printf("TEST PASSED: lockstep lanes match scalar instances\n");
+    return 0;
+}
+
+int test_profiler_counts(void) {
+    static agc_cpu_t cpu;
+    static agc_prof_t prof;
+    agc_cpu_reset(&cpu);
+    memset(&prof, 0, sizeof(prof));
+
+#ifndef AGC_PROFILER
+    if (agc_prof_attach(&cpu, &prof)) {
+        printf("TEST FAILED: profiler - attached without AGC_PROFILER\n");
+        return 1;
+    }
+    printf("TEST PASSED: profiler compiled out\n");
+    return 0;
+#else
+    // Idle loop: the profiler must count every pass, not skip them
+    agc_memory_write(&cpu, 0, 030100);  // CA 0100
+    agc_memory_write(&cpu, 1, 000000);  // TC 0
+    cpu.EB = 1;
+    agc_memory_write(&cpu, 0, 030100);
+    agc_memory_write(&cpu, 1, 000000);
+    cpu.EB = 0;
+
+    agc_prof_attach(&cpu, &prof);
+    agc_cpu_exec(&cpu, 100);
+    cpu.EB = 1;
+    agc_cpu_run(&cpu, 40, 0, NULL);
+    agc_cpu_step(&cpu);
+    agc_prof_attach(&cpu, NULL);
+    agc_cpu_exec(&cpu, 100);            // Not counted
+
+    agc_prof_hot_t hot[2];
+    size_t n = agc_prof_hottest(&prof, &cpu, hot, 2);
+    if (prof.instructions != 141 || prof.erasable[0] != 50 || prof.erasable[1] != 50 ||
+        prof.erasable[AGC_ERASE_BANK_SIZE] != 21 || prof.erasable[AGC_ERASE_BANK_SIZE + 1] != 20 ||
+        prof.opcode[3] != 71 || prof.opcode[0] != 70 ||
+        prof.eb_switches != 1 || prof.eb_enter[1] != 1 || prof.fb_switches != 0 ||
+        n != 2 || hot[0].count != 50 || hot[0].bank != 0 || hot[0].word != 030100) {
+        printf("TEST FAILED: profiler - wrong counts (%llu instructions)\n",
+               (unsigned long long)prof.instructions);
+        return 1;
+    }
+
+    printf("TEST PASSED: profiler counts every instruction by address and opcode\n");
+    return 0;
+#endif
+}
+
+/*
+ * Test bank-qualified breakpoints and watchpoints, and that clearing
+ * the last point disarms the instance.
+ */
+int test_debug_points(void) {
+    static agc_cpu_t cpu;
+    static agc_debug_t dbg;
+    agc_cpu_reset(&cpu);
+    agc_debug_init(&dbg);
+    agc_debug_attach(&cpu, &dbg);
+
+    agc_memory_write(&cpu, 0, 030100);  // CA 0100
+    agc_memory_write(&cpu, 1, 010101);  // XCH 0101
+    agc_memory_write(&cpu, 2, 020102);  // TS 0102
+    agc_memory_write(&cpu, 3, 000000);  // TC 0000
+
+    uint32_t mask = AGC_STOP_BREAKPOINT | AGC_STOP_WATCH;
+    uint64_t executed;
+
+    // Same address in another bank never fires
+    agc_debug_set(&cpu, AGC_DEBUG_EXEC, 1, 2, true);
+    agc_stop_reason_t reason = agc_cpu_run(&cpu, 100, mask, &executed);
+    if (reason != AGC_STOP_COUNT || executed != 100 || cpu.debug_armed != AGC_DEBUG_EXEC) {
+        printf("TEST FAILED: debug other bank - reason %d, executed %llu\n",
+               reason, (unsigned long long)executed);
+        return 1;
+    }
+
+    // Z is 0 after 100 instructions; the breakpoint stops before 2 runs,
+    // and running again continues past it to the next pass
+    agc_debug_set(&cpu, AGC_DEBUG_EXEC, 0, 2, true);
+    reason = agc_cpu_run(&cpu, 100, mask, &executed);
+    agc_stop_reason_t again = agc_cpu_run(&cpu, 100, mask, &executed);
+    if (reason != AGC_STOP_BREAKPOINT || again != AGC_STOP_BREAKPOINT || executed != 4 ||
+        cpu.Z != 2 || cpu.debug_hit_phys != 2) {
+        printf("TEST FAILED: debug breakpoint - reason %d/%d, executed %llu, Z=%04o\n",
+               reason, again, (unsigned long long)executed, cpu.Z);
+        return 1;
+    }
+    agc_debug_clear(&cpu, AGC_DEBUG_EXEC);
+
+    // The write watchpoint stops after TS 0102 completes
+    agc_debug_set(&cpu, AGC_DEBUG_WRITE, 0, 0102, true);
+    reason = agc_cpu_run(&cpu, 100, mask, &executed);
+    if (reason != AGC_STOP_WATCH || executed != 1 || cpu.Z != 3 ||
+        cpu.debug_hit != AGC_DEBUG_WRITE || cpu.debug_hit_phys != 0102) {
+        printf("TEST FAILED: debug write watch - reason %d, executed %llu, Z=%04o\n",
+               reason, (unsigned long long)executed, cpu.Z);
+        return 1;
+    }
+
+    // XCH both reads and writes its operand; host reads are seen too
+    agc_debug_set(&cpu, AGC_DEBUG_WRITE, 0, 0102, false);
+    agc_debug_set(&cpu, AGC_DEBUG_READ, 0, 0101, true);
+    reason = agc_cpu_run(&cpu, 100, mask, &executed);
+    if (reason != AGC_STOP_WATCH || executed != 3 || cpu.Z != 2) {
+        printf("TEST FAILED: debug read watch - reason %d, executed %llu, Z=%04o\n",
+               reason, (unsigned long long)executed, cpu.Z);
+        return 1;
+    }
+    cpu.debug_hit = 0;
+    agc_memory_read(&cpu, 0100);
+    bool quiet = cpu.debug_hit == 0;
+    agc_memory_read(&cpu, 0101);
+    if (!quiet || cpu.debug_hit != AGC_DEBUG_READ) {
+        printf("TEST FAILED: debug host read - hit %d\n", cpu.debug_hit);
+        return 1;
+    }
+
+    // Disarmed, runs take the fast path again (the loop is not idle)
+    agc_debug_clear(&cpu, AGC_DEBUG_READ);
+    reason = agc_cpu_run(&cpu, 1000, mask, &executed);
+    if (cpu.debug_armed || reason != AGC_STOP_COUNT || executed != 1000) {
+        printf("TEST FAILED: debug disarm - armed %d, reason %d\n", cpu.debug_armed, reason);
+        return 1;
+    }
+
+    printf("TEST PASSED: breakpoints and watchpoints stop runs by bank and address\n");
+    return 0;
+}
+
+/*
+ * Test that the trace ring keeps the last records of stepped and batched
+ * runs, and that a dump loads back oldest first.
+ */
+int test_trace_ring(void) {
+    static agc_cpu_t cpu;
+    agc_trace_t trace;
+    agc_cpu_reset(&cpu);
+    if (!agc_trace_init(&trace, 6)) {
+        printf("TEST FAILED: trace - cannot allocate\n");
+        return 1;
+    }
+
+    agc_memory_write(&cpu, 0, 030100);  // CA 0100
+    agc_memory_write(&cpu, 1, 010101);  // XCH 0101
+    agc_memory_write(&cpu, 2, 000000);  // TC 0000
+    agc_memory_write(&cpu, 0100, 1);
+    agc_memory_write(&cpu, 0101, 2);
+
+    agc_trace_attach(&cpu, &trace);
+    agc_cpu_step(&cpu);
+    agc_cpu_exec(&cpu, 19);
+    agc_trace_attach(&cpu, NULL);
+    agc_cpu_exec(&cpu, 10);             // Not recorded
+
+    // 20 instructions of a 5-MCT, 3-instruction loop; the ring holds 8
+    const agc_trace_rec_t *oldest = agc_trace_at(&trace, 0);
+    const agc_trace_rec_t *newest = agc_trace_at(&trace, 7);
+    if (trace.written != 20 || agc_trace_count(&trace) != 8 ||
+        oldest->z != 0 || oldest->instr != 030100 || oldest->cycle != 20 ||
+        newest->z != 1 || newest->instr != 010101 || newest->cycle != 32 || newest->a != 1) {
+        printf("TEST FAILED: trace ring - %llu written, oldest Z=%04o cycle %llu\n",
+               (unsigned long long)trace.written, oldest->z, (unsigned long long)oldest->cycle);
+        agc_trace_free(&trace);
+        return 1;
+    }
+
+    const char *path = "test_trace.bin";
+    agc_trace_header_t h;
+    agc_trace_rec_t *loaded = NULL;
+    bool ok = agc_trace_dump(&trace, path) && agc_trace_load(path, &h, &loaded) &&
+              h.count == 8 && h.dropped == 12;
+    for (size_t i = 0; ok && i < 8; i++)
+        ok = memcmp(&loaded[i], agc_trace_at(&trace, i), sizeof(agc_trace_rec_t)) == 0;
+    free(loaded);
+    remove(path);
+    agc_trace_free(&trace);
+    if (!ok) {
+        printf("TEST FAILED: trace dump - records differ after reload\n");
+        return 1;
+    }
+
+    // A capacity whose ring size would wrap size_t must be refused
+    if (agc_trace_init(&trace, (SIZE_MAX / sizeof(agc_trace_rec_t)) + 1) || trace.records) {
+        printf("TEST FAILED: trace - oversized ring accepted\n");
+        agc_trace_free(&trace);
+        return 1;
+    }
+
+    printf("TEST PASSED: trace ring keeps the last instructions and dumps them\n");
+    return 0;
+}
+
+#define CHAN_TEST_VALUES 20000
+
+// Peripheral thread: sends 1..CHAN_TEST_VALUES (wrapping at 15 bits) to IN[3]
+static void *chan_producer(void *arg) {
+    agc_channels_t *chan = arg;
+    for (int i = 1; i <= CHAN_TEST_VALUES; i++)
+        while (!agc_chan_send(chan, 3, (agc_word_t)(i & 077777)))
+            sched_yield();
+    return NULL;
+}
+
+/*
+ * Test that inputs from another thread all reach IN[] in order while the
+ * CPU runs, and that outputs queue without blocking and drop when full.
+ */
+int test_channel_queues(void) {
+    static agc_cpu_t cpu;
+    static agc_channels_t chan;
+    agc_cpu_reset(&cpu);
+    agc_chan_init(&chan);
+    agc_chan_attach(&cpu, &chan);
+    agc_memory_write(&cpu, 0, 000000);  // TC 0000
+
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, chan_producer, &chan) != 0) {
+        printf("TEST FAILED: channels - cannot start producer\n");
+        return 1;
+    }
+    while (chan.in_count[3] < CHAN_TEST_VALUES) {
+        agc_cpu_exec(&cpu, 1000);
+        sched_yield();
+    }
+    pthread_join(producer, NULL);
+
+    if (chan.in_count[3] != CHAN_TEST_VALUES || cpu.IN[3] != (CHAN_TEST_VALUES & 077777) ||
+        agc_chan_drain(&cpu) != 0) {
+        printf("TEST FAILED: channel input - %llu drained, IN[3]=%05o\n",
+               (unsigned long long)chan.in_count[3], cpu.IN[3]);
+        return 1;
+    }
+
+    // One more write than the queue holds: the last is dropped, not waited on
+    for (int i = 0; i <= AGC_CHAN_QUEUE; i++)
+        agc_io_write(&cpu, 5, (agc_word_t)i);
+    agc_word_t v;
+    int received = 0;
+    bool ordered = true;
+    while (agc_chan_recv(&chan, 5, &v))
+        ordered &= v == received++;
+    if (!ordered || received != AGC_CHAN_QUEUE || chan.out_dropped[5] != 1 ||
+        cpu.OUT[5] != AGC_CHAN_QUEUE) {
+        printf("TEST FAILED: channel output - %d received, %llu dropped\n",
+               received, (unsigned long long)chan.out_dropped[5]);
+        return 1;
+    }
+
+    printf("TEST PASSED: channel queues carry inputs and outputs between threads\n");
+    return 0;
+}
+
+/*
+ * Test that inputs drained from a peripheral thread are journaled at the
+ * cycle they were applied, so replay without the thread reproduces them.
+ */
+int test_channel_journal(void) {
+    static agc_cpu_t cpu, replayed;
+    static agc_channels_t chan;
+    static agc_snapshot_t a, b;
+    agc_journal_t rec;
+    agc_journal_init(&rec);
+    agc_cpu_reset(&cpu);
+    agc_chan_init(&chan);
+    agc_chan_attach(&cpu, &chan);
+    agc_chan_journal(&chan, &rec);
+
+    agc_memory_write(&cpu, 0, 010100);  // XCH 0100
+    agc_memory_write(&cpu, 1, 000000);  // TC 0000
+    agc_memory_write(&cpu, 0100, 01111);
+
+    agc_journal_begin(&rec, &cpu);
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, chan_producer, &chan) != 0) {
+        printf("TEST FAILED: channel journal - cannot start producer\n");
+        agc_journal_free(&rec);
+        return 1;
+    }
+    while (chan.in_count[3] < CHAN_TEST_VALUES) {
+        agc_cpu_exec(&cpu, 1001);
+        sched_yield();
+    }
+    pthread_join(producer, NULL);
+    agc_cpu_exec(&cpu, 77);
+    agc_journal_end(&rec, &cpu);
+
+    agc_cpu_reset(&replayed);
+    bool ok = agc_journal_replay(&rec, &replayed);
+
+    agc_snapshot_take(&cpu, &a);
+    agc_snapshot_take(&replayed, &b);
+    int failed = !ok || rec.count != CHAN_TEST_VALUES || memcmp(&a, &b, sizeof(a)) != 0;
+    if (failed)
+        printf("TEST FAILED: channel journal - %zu entries, IN[3]=%05o/%05o\n",
+               rec.count, cpu.IN[3], replayed.IN[3]);
+    agc_journal_free(&rec);
+    if (failed) return 1;
+
+    printf("TEST PASSED: drained channel inputs replay from the journal\n");
+    return 0;
+}
+
+typedef struct {
+    uint64_t cycle[8];
+    char tag[8];
+    int count;
+} sched_log_t;
+
+static sched_log_t sched_log;
+
+static void sched_record(agc_cpu_t *cpu, void *ctx) {
+    sched_log.cycle[sched_log.count] = cpu->cycle_count;
+    sched_log.tag[sched_log.count++] = *(const char *)ctx;
+}
+
+// Reschedules itself for "now", which defers it to the next boundary
+static void sched_again(agc_cpu_t *cpu, void *ctx) {
+    sched_record(cpu, ctx);
+    agc_sched_at(cpu, cpu->cycle_count, sched_record, "e");
+}
+
+/*
+ * Test that events fire in cycle order, ties in scheduling order, at the
+ * boundary where they come due, also when an idle loop is skipped.
+ */
+int test_sched_events(void) {
+    static agc_cpu_t cpu;
+    static agc_sched_t sched;
+
+    for (int pass = 0; pass < 2; pass++) {
+        agc_cpu_reset(&cpu);
+        cpu.idle_skip = pass == 0;
+        agc_sched_init(&sched);
+        agc_sched_attach(&cpu, &sched);
+        agc_memory_write(&cpu, 0, 000000);  // TC 0000: 1 MCT per instruction
+        memset(&sched_log, 0, sizeof(sched_log));
+
+        agc_sched_at(&cpu, 5, sched_record, "b");
+        agc_sched_at(&cpu, 3, sched_record, "a");
+        agc_sched_at(&cpu, 5, sched_record, "c");
+        uint32_t dropped = agc_sched_after(&cpu, 7, sched_record, "x");
+        agc_sched_at(&cpu, 9, sched_again, "d");
+        bool cancelled = agc_sched_cancel(&cpu, dropped) && !agc_sched_cancel(&cpu, dropped);
+
+        uint64_t executed = agc_cpu_exec(&cpu, 100);
+        if (!cancelled || executed != 100 || sched_log.count != 5 ||
+            memcmp(sched_log.tag, "abcde", 5) != 0 ||
+            sched_log.cycle[0] != 3 || sched_log.cycle[1] != 5 || sched_log.cycle[2] != 5 ||
+            sched_log.cycle[3] != 9 || sched_log.cycle[4] != 10 ||
+            cpu.next_event != UINT64_MAX || sched.fired != 5) {
+            printf("TEST FAILED: sched events (idle skip %s) - %d fired, order %.*s\n",
+                   pass == 0 ? "on" : "off", sched_log.count, sched_log.count, sched_log.tag);
+            return 1;
+        }
+    }
+
+    printf("TEST PASSED: scheduled events fire in cycle order\n");
+    return 0;
+}
+
+/*
+ * Test the timers against hand-computed times. The loop is 1 MCT per
+ * instruction and every counter increment steals one more:
+ *   - TIME4 ticks at pulse 7680 = cycle 640, leaving 641.
+ *   - TIME1/3/5 tick at pulse 10240, first reached at cycle 854; TIME1
+ *     and TIME3 overflow, so TIME2 also counts: four increments, 858.
+ *   - TIME6 from 2: ticks at cycles 907, 960 and 1014, the last at zero.
+ */
+int test_sched_timers(void) {
+    static agc_cpu_t cpu;
+    static agc_sched_t sched;
+
+    for (int pass = 0; pass < 2; pass++) {
+        agc_cpu_reset(&cpu);
+        cpu.idle_skip = pass == 0;
+        agc_sched_init(&sched);
+        agc_sched_attach(&cpu, &sched);
+        agc_memory_write(&cpu, 0, 000000);  // TC 0000
+        agc_memory_write(&cpu, AGC_TIME1, 037777);
+        agc_memory_write(&cpu, AGC_TIME3, 037777);
+        agc_sched_timers(&cpu, true);
+
+        uint64_t executed;
+        agc_stop_reason_t reason = agc_cpu_run(&cpu, 1000000, AGC_STOP_RUPT, &executed);
+        if (reason != AGC_STOP_RUPT || executed != 853 || cpu.cycle_count != 858 ||
+            cpu.rupt_pending != 1u << AGC_RUPT_T3 ||
+            cpu.erasable[AGC_TIME1] != 0 || cpu.erasable[AGC_TIME2] != 1 ||
+            cpu.erasable[AGC_TIME4] != 1 || cpu.erasable[AGC_TIME5] != 1) {
+            printf("TEST FAILED: sched TIME1-5 (idle skip %s) - %llu executed, cycle %llu, rupts %o\n",
+                   pass == 0 ? "on" : "off", (unsigned long long)executed,
+                   (unsigned long long)cpu.cycle_count, cpu.rupt_pending);
+            return 1;
+        }
+
+        cpu.rupt_pending = 0;
+        agc_memory_write(&cpu, AGC_TIME6, 2);
+        agc_io_write(&cpu, AGC_CHAN_TIME6, AGC_TIME6_ENABLE);
+        reason = agc_cpu_run(&cpu, 1000000, AGC_STOP_RUPT, &executed);
+        if (reason != AGC_STOP_RUPT || cpu.cycle_count != 1015 ||
+            cpu.rupt_pending != 1u << AGC_RUPT_T6 ||
+            cpu.erasable[AGC_TIME6] != 0 || cpu.OUT[AGC_CHAN_TIME6] != 0) {
+            printf("TEST FAILED: sched TIME6 (idle skip %s) - cycle %llu, rupts %o\n",
+                   pass == 0 ? "on" : "off", (unsigned long long)cpu.cycle_count, cpu.rupt_pending);
+            return 1;
+        }
+
+        agc_sched_timers(&cpu, false);
+        if (sched.count != 0 || cpu.next_event != UINT64_MAX) {
+            printf("TEST FAILED: sched timers - %u events left after stopping\n", sched.count);
+            return 1;
+        }
+    }
+
+    printf("TEST PASSED: timers count and request interrupts on time\n");
+    return 0;
+}
+
+/*
+ * Test that erasable memory in a core file survives closing it and comes
+ * back in a fresh instance, and that detaching keeps the instance's state.
+ */
+int test_core_file(void) {
+    static agc_cpu_t cpu, resumed;
+    agc_corefile_t file;
+    const char *path = "test_core.agce";
+    remove(path);
+
+    agc_cpu_reset(&cpu);
+    agc_memory_write(&cpu, 0, 030100);  // CA 0100
+    agc_memory_write(&cpu, 1, 012101);  // TS 02101 (bank-relative 0101)
+    agc_memory_write(&cpu, 2, 000000);  // TC 0000
+    agc_memory_write(&cpu, 0100, 012345);
+    cpu.EB = 1;
+    agc_memory_write(&cpu, 0100, 054321);
+    cpu.EB = 0;
+
+    // A new file starts cleared and takes over from the instance's storage
+    if (!agc_corefile_open(&file, path) || !file.created) {
+        printf("TEST FAILED: core file - cannot create %s\n", path);
+        return 1;
+    }
+    agc_corefile_attach(&cpu, &file);
+    if (cpu.erasable != file.words || agc_memory_read(&cpu, 0100) != 0) {
+        printf("TEST FAILED: core file - new file not clear\n");
+        agc_corefile_close(&file);
+        return 1;
+    }
+    agc_memory_write(&cpu, 0, 030100);
+    agc_memory_write(&cpu, 1, 012101);
+    agc_memory_write(&cpu, 2, 000000);
+    agc_memory_write(&cpu, 0100, 012345);
+    agc_cpu_exec(&cpu, 3);              // Program writes go to the file too
+    cpu.EB = 1;
+    agc_memory_write(&cpu, 0100, 054321);
+    cpu.EB = 0;
+
+    bool synced = agc_corefile_sync(&file);
+    agc_corefile_close(&file);
+    bool kept = cpu.erasable == cpu.erasable_store && cpu.corefile == NULL &&
+                agc_erasable_get(&cpu, 0, 0101) == 012345 &&
+                agc_erasable_get(&cpu, 1, 0100) == 054321;
+    if (!synced || !kept) {
+        printf("TEST FAILED: core file - sync %d, detached copy %s\n", synced, kept ? "ok" : "wrong");
+        remove(path);
+        return 1;
+    }
+
+    agc_cpu_reset(&resumed);
+    bool ok = agc_corefile_open(&file, path) && !file.created;
+    if (ok) {
+        agc_corefile_attach(&resumed, &file);
+        ok = memcmp(resumed.erasable, cpu.erasable, AGC_RAM_BYTES) == 0 &&
+             agc_memory_read(&resumed, 0101) == 012345;
+        agc_corefile_close(&file);
+    }
+    if (!ok) {
+        printf("TEST FAILED: core file - contents not resumed\n");
+        remove(path);
+        return 1;
+    }
+
+    // Not a core file: refused, and left alone
+    FILE *f = fopen(path, "wb");
+    fputs("not a core file", f);
+    fclose(f);
+    ok = !agc_corefile_open(&file, path);
+    remove(path);
+    if (!ok) {
+        printf("TEST FAILED: core file - accepted a foreign file\n");
+        return 1;
+    }
+
+    printf("TEST PASSED: core file keeps erasable memory across instances\n");
+    return 0;
+}
+
+#define CKPT_TEST_COUNT 6
+
+/*
+ * Test that checkpoints of a hot fixed-memory loop store only the pages
+ * it writes, and that each rebuilds to the snapshot taken at the time.
+ */
+int test_checkpoint_deltas(void) {
+    static agc_rope_t rope;
+    static agc_cpu_t cpu;
+    static agc_snapshot_t want[CKPT_TEST_COUNT], got;
+    agc_ckpt_log_t log;
+
+    // The loop head writes 0100; the fixed-memory part, a superblock
+    // where built, writes another page. Runs are whole 6-instruction
+    // passes, so once the block is hot no stepped instruction marks it.
+    rope.words[010000] = 020201;  // TS 0201
+    rope.words[010001] = 010202;  // XCH 0202
+    rope.words[010002] = 030201;  // CA 0201
+    rope.words[010003] = 020203;  // TS 0203
+    rope.words[010004] = 001777;  // TC 1777
+    agc_rope_decode(&rope);
+
+    agc_cpu_reset(&cpu);
+    load_fixed_loop(&cpu, &rope);
+    agc_ckpt_init(&log);
+    memset(want, 0, sizeof(want));
+
+    bool sizes = true;
+    for (int i = 0; i < CKPT_TEST_COUNT; i++) {
+        if (i == 3) cpu.EB = 1;         // Same loop, other bank's page
+        if (i == 5) agc_erasable_set(&cpu, 0, 0777, 1);  // Host write to one more page
+        if (i > 0) agc_cpu_exec(&cpu, 1002);
+
+        agc_snapshot_take(&cpu, &want[i]);
+        if (!agc_ckpt_take(&log, &cpu)) {
+            printf("TEST FAILED: checkpoint - out of memory\n");
+            agc_ckpt_free(&log);
+            return 1;
+        }
+        size_t pages = agc_ckpt_words(&log, (size_t)i) / AGC_DIRTY_WORDS;
+        sizes &= pages == (i == 0 ? AGC_DIRTY_PAGES : i == 5 ? 3 : 2);
+    }
+
+    // Rebuild out of order, each against the state when it was taken
+    const int order[CKPT_TEST_COUNT] = { 4, 0, 5, 2, 1, 3 };
+    bool same = true;
+    for (int k = 0; k < CKPT_TEST_COUNT; k++) {
+        memset(&got, 0, sizeof(got));
+        same &= agc_ckpt_rebuild(&log, (size_t)order[k], &got) &&
+                memcmp(&got, &want[order[k]], sizeof(got)) == 0;
+    }
+    bool bounded = !agc_ckpt_rebuild(&log, CKPT_TEST_COUNT, &got);
+
+    // A rebuilt checkpoint restores and runs on like the original
+    agc_ckpt_rebuild(&log, 3, &got);
+    agc_snapshot_restore(&cpu, &got);
+    agc_cpu_exec(&cpu, 1002);
+    agc_snapshot_take(&cpu, &got);
+    bool resumed = memcmp(got.erasable, want[4].erasable, sizeof(got.erasable)) == 0 &&
+                   cpu.A == want[4].A && cpu.cycle_count == want[4].cycle_count;
+    agc_ckpt_free(&log);
+
+    if (!sizes || !same || !bounded || !resumed) {
+        printf("TEST FAILED: checkpoint deltas - sizes %d, rebuilds %d, bounds %d, resume %d\n",
+               sizes, same, bounded, resumed);
+        return 1;
+    }
+
+    printf("TEST PASSED: checkpoints store written pages and rebuild exactly\n");
+    return 0;
+}
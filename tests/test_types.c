@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+#include "agc_words.h"
+
+/*
+ * Word arithmetic kernels, checked exhaustively: every 15-bit operand
+ * (pair) goes through the scalar reference, which is compared with an
+ * independent integer model, and through the vector kernels, which are
+ * compared with the reference.
+ *
+ * test_types runs the kernels the core library was built with (SSE2 on
+ * x86-64) and test_types_avx2 the AVX2 ones. On x86 hosts the NEON
+ * path is compile-only; it is built and checked on ARM hosts alone.
+ */
+
+#define WORDS 0100000   // 2^15
+
+int test_add_exhaustive(void);
+int test_dp_exhaustive(void);
+int test_negate_sign(void);
+
+static agc_word_t all[WORDS], row[WORDS], ref[WORDS], vec[WORDS];
+static int32_t dp_ref[WORDS], dp_vec[WORDS];
+
+int main(void) {
+    int failed = 0;
+
+    for (int i = 0; i < WORDS; i++)
+        all[i] = (agc_word_t)i;
+
+    failed |= test_negate_sign();
+    failed |= test_add_exhaustive();
+    failed |= test_dp_exhaustive();
+
+    if (failed) {
+        printf("SOME TESTS FAILED\n");
+        return 1;
+    }
+    printf("ALL TESTS PASSED\n");
+    return 0;
+}
+
+// Model values: a negative word w stands for w - 077777
+static int32_t model_value(int32_t w) {
+    return w < 040000 ? w : w - 077777;
+}
+
+int test_negate_sign(void) {
+    static uint8_t neg_ref[WORDS], neg_vec[WORDS];
+
+    agc_negate_n_scalar(ref, all, WORDS);
+    agc_negate_n(vec, all, WORDS);
+    size_t count_ref = agc_sign_n_scalar(neg_ref, all, WORDS);
+    size_t count_vec = agc_sign_n(neg_vec, all, WORDS);
+
+    for (int i = 0; i < WORDS; i++) {
+        if (ref[i] != 077777 - i || vec[i] != ref[i] ||
+            neg_ref[i] != (i >= 040000) || neg_vec[i] != neg_ref[i]) {
+            printf("TEST FAILED: negate/sign - word %05o\n", i);
+            return 1;
+        }
+    }
+    if (count_ref != WORDS / 2 || count_vec != count_ref) {
+        printf("TEST FAILED: sign - counted %zu/%zu negatives\n", count_ref, count_vec);
+        return 1;
+    }
+
+    printf("TEST PASSED: negate and sign test match for all words\n");
+    return 0;
+}
+
+int test_add_exhaustive(void) {
+    for (int a = 0; a < WORDS; a++) {
+        for (int b = 0; b < WORDS; b++)
+            row[b] = (agc_word_t)a;
+
+        agc_add_n_scalar(ref, row, all, WORDS);
+        agc_add_n(vec, row, all, WORDS);
+
+        for (int b = 0; b < WORDS; b++) {
+            // End-around carry: a 16-bit sum wraps by 2^15 - 1
+            int32_t sum = a + b;
+            int32_t expect = sum < 0100000 ? sum : sum - 077777;
+            if (ref[b] != expect || vec[b] != ref[b]) {
+                printf("TEST FAILED: add - %05o + %05o = %05o (vector %05o), expected %05o\n",
+                       a, b, ref[b], vec[b], expect);
+                return 1;
+            }
+        }
+    }
+
+    printf("TEST PASSED: one's-complement add matches for all 2^30 pairs\n");
+    return 0;
+}
+
+int test_dp_exhaustive(void) {
+    for (int hi = 0; hi < WORDS; hi++) {
+        for (int lo = 0; lo < WORDS; lo++)
+            row[lo] = (agc_word_t)hi;
+
+        agc_dp_n_scalar(dp_ref, row, all, WORDS);
+        agc_dp_n(dp_vec, row, all, WORDS);
+
+        int32_t high = model_value(hi) * 040000;
+        for (int lo = 0; lo < WORDS; lo++) {
+            int32_t expect = high + model_value(lo);
+            if (dp_ref[lo] != expect || dp_vec[lo] != expect) {
+                printf("TEST FAILED: dp - (%05o, %05o) = %ld (vector %ld), expected %ld\n",
+                       hi, lo, (long)dp_ref[lo], (long)dp_vec[lo], (long)expect);
+                return 1;
+            }
+        }
+    }
+
+    printf("TEST PASSED: double-precision pairing matches for all 2^30 pairs\n");
+    return 0;
+}
@@ -0,0 +1,200 @@
+/*
+ * agc_campaign - run one rope many times with perturbed inputs.
+ *
+ *   agc_campaign [-j threads] [-n max_instructions] [-o] [-r rope] runs.txt results.bin
+ *
+ * runs.txt has one run per line. A line holds whitespace-separated
+ * perturbations, all values octal:
+ *
+ *   A=v L=v Q=v Z=v EB=v FB=v    registers
+ *   IN<ch>=v                     input channel
+ *   E<bank>:<addr>=v             erasable word
+ *
+ * A line starting with "base" sets up the state every run starts from
+ * (applied to a reset CPU); "-" is a run with no perturbations; '#'
+ * starts a comment. With -o a run also stops at its first output
+ * channel write. Results are written as described in agc_campaign.h.
+ */
+#define _POSIX_C_SOURCE 200809L    // strtok_r
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "agc_campaign.h"
+#include "agc_rope.h"
+
+typedef struct {
+    agc_perturbation_t *items;
+    size_t count, capacity;
+    size_t *first;
+    size_t runs, run_capacity;
+} run_list_t;
+
+static bool push_item(run_list_t *list, agc_perturbation_t p) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 256;
+        agc_perturbation_t *items = realloc(list->items, capacity * sizeof(*items));
+        if (!items) return false;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = p;
+    return true;
+}
+
+// Close the current run; first[runs] is where the next run starts
+static bool push_run(run_list_t *list) {
+    if (list->runs + 2 > list->run_capacity) {
+        size_t capacity = list->run_capacity ? list->run_capacity * 2 : 256;
+        size_t *first = realloc(list->first, capacity * sizeof(*first));
+        if (!first) return false;
+        list->first = first;
+        list->run_capacity = capacity;
+    }
+    if (list->runs == 0) list->first[0] = 0;
+    list->first[++list->runs] = list->count;
+    return true;
+}
+
+static bool parse_item(const char *tok, agc_perturbation_t *p) {
+    static const char *regs[] = { "A", "L", "Q", "Z", "EB", "FB" };
+    unsigned a, b, v;
+    char tail;
+
+    memset(p, 0, sizeof(*p));
+    if (sscanf(tok, "E%o:%o=%o%c", &a, &b, &v, &tail) == 3) {
+        *p = (agc_perturbation_t){ AGC_PERTURB_ERASABLE, (uint8_t)a, (uint16_t)b, (agc_word_t)v };
+        return true;
+    }
+    if (sscanf(tok, "IN%o=%o%c", &a, &v, &tail) == 2) {
+        *p = (agc_perturbation_t){ AGC_PERTURB_IN, 0, (uint16_t)a, (agc_word_t)v };
+        return true;
+    }
+    const char *eq = strchr(tok, '=');
+    if (!eq || sscanf(eq + 1, "%o%c", &v, &tail) != 1)
+        return false;
+    for (unsigned r = 0; r < sizeof(regs) / sizeof(regs[0]); r++) {
+        if (strlen(regs[r]) == (size_t)(eq - tok) && strncmp(tok, regs[r], (size_t)(eq - tok)) == 0) {
+            *p = (agc_perturbation_t){ AGC_PERTURB_REG, 0, (uint16_t)r, (agc_word_t)v };
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_runs(FILE *f, agc_cpu_t *base, run_list_t *list) {
+    char line[1024];
+    int lineno = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char *save = NULL;
+        char *tok = strtok_r(line, " \t\r\n", &save);
+        if (!tok) continue;
+
+        bool is_base = strcmp(tok, "base") == 0;
+        if (is_base || strcmp(tok, "-") == 0)
+            tok = strtok_r(NULL, " \t\r\n", &save);
+
+        for (; tok; tok = strtok_r(NULL, " \t\r\n", &save)) {
+            agc_perturbation_t p;
+            if (!parse_item(tok, &p)) {
+                fprintf(stderr, "line %d: bad perturbation '%s'\n", lineno, tok);
+                return false;
+            }
+            if (is_base)
+                agc_perturb_apply(base, &p);
+            else if (!push_item(list, p))
+                return false;
+        }
+        if (!is_base && !push_run(list))
+            return false;
+    }
+    return true;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: agc_campaign [-j threads] [-n max_instructions] [-o] [-r rope] "
+                    "runs.txt results.bin\n");
+}
+
+int main(int argc, char **argv) {
+    agc_campaign_t c = { .max_instructions = 1000000 };
+    const char *rope_path = NULL;
+    int argi = 1;
+
+    for (; argi < argc && argv[argi][0] == '-' && argv[argi][1]; argi++) {
+        const char *opt = argv[argi];
+        if (strcmp(opt, "-o") == 0) {
+            c.stop_mask |= AGC_STOP_IO_WRITE;
+        } else if (argi + 1 < argc && strcmp(opt, "-j") == 0) {
+            c.threads = (unsigned)strtoul(argv[++argi], NULL, 10);
+        } else if (argi + 1 < argc && strcmp(opt, "-n") == 0) {
+            c.max_instructions = strtoull(argv[++argi], NULL, 10);
+        } else if (argi + 1 < argc && strcmp(opt, "-r") == 0) {
+            rope_path = argv[++argi];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (argc - argi != 2) {
+        usage();
+        return 2;
+    }
+
+    if (rope_path) {
+        c.rope = agc_rope_acquire(rope_path, NULL);
+        if (!c.rope) {
+            fprintf(stderr, "cannot load rope %s\n", rope_path);
+            return 1;
+        }
+    }
+
+    static agc_cpu_t base;
+    static agc_snapshot_t snap;
+    agc_cpu_reset(&base);
+    agc_memory_attach_rope(&base, c.rope);
+
+    FILE *in = fopen(argv[argi], "r");
+    if (!in) {
+        perror(argv[argi]);
+        return 1;
+    }
+    run_list_t list = { 0 };
+    bool parsed = parse_runs(in, &base, &list);
+    fclose(in);
+    if (!parsed || list.runs == 0) {
+        fprintf(stderr, "%s: no runs\n", argv[argi]);
+        return 1;
+    }
+
+    agc_snapshot_take(&base, &snap);
+    c.base = &snap;
+    c.runs = (agc_run_set_t){ list.items, list.first, list.runs };
+
+    c.out = fopen(argv[argi + 1], "wb");
+    if (!c.out) {
+        perror(argv[argi + 1]);
+        return 1;
+    }
+
+    struct timespec t0, t1;
+    timespec_get(&t0, TIME_UTC);
+    bool ok = agc_campaign_run(&c);
+    timespec_get(&t1, TIME_UTC);
+    ok = (fclose(c.out) == 0) && ok;
+
+    double sec = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("%zu runs in %.3f s (%.0f runs/s)%s\n", list.runs, sec,
+           sec > 0 ? (double)list.runs / sec : 0.0, ok ? "" : ", FAILED");
+
+    agc_rope_release(c.rope);
+    free(list.items);
+    free(list.first);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+/*
+ * agc_trace - decode a binary instruction trace into text.
+ *
+ *   agc_trace [-n last] trace.bin
+ *
+ * Prints one line per record, oldest first: cycle, bank:address,
+ * instruction word, A before the instruction and its disassembly.
+ * With -n only the last records are printed.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "agc_trace.h"
+
+static void usage(void) {
+    fprintf(stderr, "usage: agc_trace [-n last] trace.bin\n");
+}
+
+int main(int argc, char **argv) {
+    unsigned long long last = 0;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            last = strtoull(argv[++i], NULL, 10);
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!path) {
+        usage();
+        return 2;
+    }
+
+    agc_trace_header_t h;
+    agc_trace_rec_t *records;
+    if (!agc_trace_load(path, &h, &records)) {
+        fprintf(stderr, "%s: not a readable trace (version %d expected)\n", path, AGC_TRACE_VERSION);
+        return 1;
+    }
+
+    printf("# %llu records, %llu older records dropped\n",
+           (unsigned long long)h.count, (unsigned long long)h.dropped);
+    printf("# %10s  %-8s  %-5s  %-7s  %s\n", "cycle", "where", "word", "A", "instruction");
+
+    uint64_t first = last && last < h.count ? h.count - last : 0;
+    for (uint64_t i = first; i < h.count; i++) {
+        char line[96];
+        agc_trace_format(&records[i], line, sizeof(line));
+        puts(line);
+    }
+    free(records);
+    return 0;
+}